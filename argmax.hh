@@ -0,0 +1,119 @@
+#pragma once
+// for int64_t
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ARGMAX_X86 1
+// for the SSE4.2 and AVX2 intrinsics, enabled per function with the target attribute
+#include <immintrin.h>
+#endif
+
+// Index of the largest non negative key, -1 if every key is negative
+// Keys of absent entries are -1, so the scan is a plain maximum over the whole array with
+// no branch on membership. Ties go to the smallest index. The kernel is picked at run time
+// from what the CPU supports; argmax_level() can be lowered to compare kernels.
+
+enum class simd_level { scalar, sse42, avx2 };
+
+inline const char* simd_level_name(simd_level level) {
+	return level == simd_level::avx2 ? "avx2" : level == simd_level::sse42 ? "sse4.2" : "scalar";
+}
+
+// best kernel the CPU supports
+inline simd_level detected_simd_level() {
+#ifdef ARGMAX_X86
+	if (__builtin_cpu_supports("avx2")) return simd_level::avx2;
+	if (__builtin_cpu_supports("sse4.2")) return simd_level::sse42;
+#endif
+	return simd_level::scalar;
+}
+
+// kernel used by argmax, the detected one unless changed
+inline simd_level& argmax_level() {
+	static simd_level level = detected_simd_level();
+	return level;
+}
+
+// from index `from` on, compiled to conditional moves
+inline int _argmax_scalar(int64_t const* key, int n, int from, int64_t best, int best_index) {
+	for (int i = from; i < n; ++i) {
+		bool greater = key[i] > best;
+		best = greater ? key[i] : best;
+		best_index = greater ? i : best_index;
+	}
+	return best_index;
+}
+
+// reduce lanes holding the best key and its index for a stride of the array
+inline int _argmax_lanes(int64_t const* best, int64_t const* index, int lanes, int64_t* top) {
+	int64_t b = -1, bi = -1;
+	for (int l = 0; l < lanes; ++l)
+		if (best[l] > b || (best[l] == b && best[l] >= 0 && index[l] < bi)) {
+			b = best[l];
+			bi = index[l];
+		}
+	*top = b;
+	return (int)bi;
+}
+
+#ifdef ARGMAX_X86
+__attribute__((target("sse4.2"))) inline int _argmax_sse42(int64_t const* key, int n) {
+	__m128i best[2], index[2];
+	__m128i at = _mm_set_epi64x(1, 0), step = _mm_set1_epi64x(2);
+	best[0] = best[1] = index[0] = index[1] = _mm_set1_epi64x(-1);
+	int i = 0;
+	// two independent accumulators, the first over even pairs, the second over odd ones
+	for (; i + 4 <= n; i += 4) {
+		for (int a = 0; a < 2; ++a) {
+			__m128i v = _mm_loadu_si128((__m128i const*)(key + i + 2 * a));
+			__m128i greater = _mm_cmpgt_epi64(v, best[a]);
+			best[a] = _mm_blendv_epi8(best[a], v, greater);
+			index[a] = _mm_blendv_epi8(index[a], at, greater);
+			at = _mm_add_epi64(at, step);
+		}
+	}
+	alignas(16) int64_t b[4], bi[4];
+	_mm_store_si128((__m128i*)b, best[0]);
+	_mm_store_si128((__m128i*)(b + 2), best[1]);
+	_mm_store_si128((__m128i*)bi, index[0]);
+	_mm_store_si128((__m128i*)(bi + 2), index[1]);
+	int64_t top;
+	int top_index = _argmax_lanes(b, bi, 4, &top);
+	return _argmax_scalar(key, n, i, top, top_index);
+}
+
+__attribute__((target("avx2"))) inline int _argmax_avx2(int64_t const* key, int n) {
+	__m256i best[2], index[2];
+	__m256i at = _mm256_set_epi64x(3, 2, 1, 0), step = _mm256_set1_epi64x(4);
+	best[0] = best[1] = index[0] = index[1] = _mm256_set1_epi64x(-1);
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		for (int a = 0; a < 2; ++a) {
+			__m256i v = _mm256_loadu_si256((__m256i const*)(key + i + 4 * a));
+			__m256i greater = _mm256_cmpgt_epi64(v, best[a]);
+			best[a] = _mm256_blendv_epi8(best[a], v, greater);
+			index[a] = _mm256_blendv_epi8(index[a], at, greater);
+			at = _mm256_add_epi64(at, step);
+		}
+	}
+	alignas(32) int64_t b[8], bi[8];
+	_mm256_store_si256((__m256i*)b, best[0]);
+	_mm256_store_si256((__m256i*)(b + 4), best[1]);
+	_mm256_store_si256((__m256i*)bi, index[0]);
+	_mm256_store_si256((__m256i*)(bi + 4), index[1]);
+	int64_t top;
+	int top_index = _argmax_lanes(b, bi, 8, &top);
+	return _argmax_scalar(key, n, i, top, top_index);
+}
+#endif
+
+inline int argmax(int64_t const* key, int n) {
+#ifdef ARGMAX_X86
+	switch (argmax_level()) {
+		case simd_level::avx2: return _argmax_avx2(key, n);
+		case simd_level::sse42: return _argmax_sse42(key, n);
+		default: break;
+	}
+#endif
+	return _argmax_scalar(key, n, 0, -1, -1);
+}
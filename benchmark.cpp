@@ -0,0 +1,419 @@
+// Benchmark harness for the maximum bandwidth path algorithms
+// Builds one graph, answers the same random queries with every selected algorithm over
+// several trials and reports latency percentiles and throughput, plus the time spent on
+// construction. Every algorithm must agree on every bandwidth, otherwise it exits with 1.
+//
+//   ./bench --type 2 --n 5000 --queries 50 --trials 5 --csv out.csv --json out.json
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "generator.hh"
+#include "graph.hh"
+#include "graph_file.hh"
+
+struct options {
+	int type = 1;
+	int n = 5000;
+	// average degree, 0 keeps the default of the graph type
+	int degree = 0;
+	unsigned seed = 42;
+	// parallel uses graph_generator instead of the graph's own sequential generator
+	bool parallel = false;
+	int threads = 0;
+	// map this graph file instead of generating a graph, and where to save the graph
+	const char* load = nullptr;
+	const char* save = nullptr;
+	// map this oracle file instead of building the oracle, and where to save the oracle
+	const char* load_oracle = nullptr;
+	const char* save_oracle = nullptr;
+	int queries = 100;
+	int trials = 5;
+	int warmup = 10;
+	const char* algorithms = "d1,d2,kruskal";
+	const char* heap = "binary";
+	// weight type of the graph: int64, int32, uint32, uint16 or double
+	const char* weights = "int64";
+	// vertex renumbering applied after building the graph
+	vertex_order order = vertex_order::none;
+	// kernel of the max fringe scan in d1
+	simd_level simd = detected_simd_level();
+	const char* csv = nullptr;
+	const char* json = nullptr;
+};
+
+struct algorithm {
+	const char* name;
+	const char* description;
+	bool enabled;
+};
+
+static algorithm algorithms[] = {
+	{"d1", "Dijkstra without heap", false},
+	{"d2", "Dijkstra with heap", false},
+	{"d2-early", "Dijkstra with heap, stopping at the target", false},
+	{"bidi", "Bidirectional Dijkstra with heap", false},
+	{"kruskal", "Kruskal's + BFS", false},
+	{"oracle", "Bottleneck oracle on a prebuilt tree", false},
+	{"oracle-path", "Widest path from the bottleneck oracle", false},
+};
+static const int n_algorithms = sizeof(algorithms) / sizeof(algorithms[0]);
+
+struct summary {
+	double median, p95, p99, mean, throughput;
+};
+
+static void usage(const char* prog) {
+	std::cerr << "usage: " << prog << " [options]\n"
+			  << "  --type 1|2          graph type (default 1)\n"
+			  << "  --n N               number of vertices (default 5000)\n"
+			  << "  --degree D          average degree (default 6 for G1, n / 5 for G2)\n"
+			  << "  --seed S            seed of the graph and the queries (default 42)\n"
+			  << "  --generator G       serial or parallel (default serial)\n"
+			  << "  --threads N         threads of the parallel generator (default all)\n"
+			  << "  --graph FILE        map a graph file instead of generating a graph\n"
+			  << "  --save FILE         write the graph to a graph file\n"
+			  << "  --oracle FILE       map an oracle file saved for the same graph instead of\n"
+			  << "                      building the oracle\n"
+			  << "  --save-oracle FILE  write the oracle to an oracle file\n"
+			  << "  --queries Q         random (s, t) pairs per trial (default 100)\n"
+			  << "  --trials T          timed repetitions of all queries (default 5)\n"
+			  << "  --warmup W          untimed queries per algorithm (default 10)\n"
+			  << "  --algorithms LIST   comma separated names below, or all (default d1,d2,kruskal)\n";
+	for (int a = 0; a < n_algorithms; ++a)
+		std::cerr << "      " << algorithms[a].name << ": " << algorithms[a].description << "\n";
+	std::cerr << "  --heap H            binary, 4ary, 8ary, pairing or radix (default binary)\n"
+			  << "  --weights W         int64, int32, uint32, uint16 or double (default int64)\n"
+			  << "  --order O           renumber the vertices in none, bfs, rcm or degree order\n"
+			  << "                      (default none, see reorder.hh)\n"
+			  << "  --simd K            scalar, sse4.2 or avx2 max fringe scan for d1 (default "
+			  << simd_level_name(detected_simd_level()) << ", the best supported)\n"
+			  << "  --csv FILE          write results as CSV\n"
+			  << "  --json FILE         write results as JSON\n";
+}
+
+static bool parse(int argc, char** argv, options& opt) {
+	for (int i = 1; i < argc; ++i) {
+		auto is = [&](const char* flag) { return std::strcmp(argv[i], flag) == 0 && i + 1 < argc; };
+		if (is("--type")) opt.type = std::atoi(argv[++i]);
+		else if (is("--n"))
+			opt.n = std::atoi(argv[++i]);
+		else if (is("--degree"))
+			opt.degree = std::atoi(argv[++i]);
+		else if (is("--seed"))
+			opt.seed = std::strtoul(argv[++i], nullptr, 10);
+		else if (is("--generator")) {
+			std::string name = argv[++i];
+			if (name != "serial" && name != "parallel") return false;
+			opt.parallel = name == "parallel";
+		} else if (is("--threads"))
+			opt.threads = std::atoi(argv[++i]);
+		else if (is("--graph"))
+			opt.load = argv[++i];
+		else if (is("--save"))
+			opt.save = argv[++i];
+		else if (is("--oracle"))
+			opt.load_oracle = argv[++i];
+		else if (is("--save-oracle"))
+			opt.save_oracle = argv[++i];
+		else if (is("--queries"))
+			opt.queries = std::atoi(argv[++i]);
+		else if (is("--trials"))
+			opt.trials = std::atoi(argv[++i]);
+		else if (is("--warmup"))
+			opt.warmup = std::atoi(argv[++i]);
+		else if (is("--algorithms"))
+			opt.algorithms = argv[++i];
+		else if (is("--heap"))
+			opt.heap = argv[++i];
+		else if (is("--weights"))
+			opt.weights = argv[++i];
+		else if (is("--order")) {
+			std::string name = argv[++i];
+			int o = 0;
+			while (o <= (int)vertex_order::degree && name != vertex_order_name((vertex_order)o)) ++o;
+			if (o > (int)vertex_order::degree) return false;
+			opt.order = (vertex_order)o;
+		}
+		else if (is("--simd")) {
+			std::string name = argv[++i];
+			if (name == "scalar") opt.simd = simd_level::scalar;
+			else if (name == "sse4.2")
+				opt.simd = simd_level::sse42;
+			else if (name == "avx2")
+				opt.simd = simd_level::avx2;
+			else
+				return false;
+			if (opt.simd > detected_simd_level()) {
+				std::cerr << name << " is not supported by this CPU" << std::endl;
+				return false;
+			}
+		} else if (is("--csv"))
+			opt.csv = argv[++i];
+		else if (is("--json"))
+			opt.json = argv[++i];
+		else
+			return false;
+	}
+	if ((opt.type != 1 && opt.type != 2) || opt.n < (opt.parallel ? 3 : 2) || opt.queries < 1 ||
+		opt.trials < 1)
+		return false;
+	std::string heap_name = opt.heap, weights = opt.weights;
+	if (heap_name != "binary" && heap_name != "4ary" && heap_name != "8ary" &&
+		heap_name != "pairing" && heap_name != "radix")
+		return false;
+	if (weights != "int64" && weights != "int32" && weights != "uint32" && weights != "uint16" &&
+		weights != "double")
+		return false;
+	if (heap_name == "radix" && weights == "double") {
+		std::cerr << "radix needs integer weights" << std::endl;
+		return false;
+	}
+	std::string list = opt.algorithms;
+	size_t start = 0;
+	while (start <= list.size()) {
+		size_t end = list.find(',', start);
+		if (end == std::string::npos) end = list.size();
+		std::string name = list.substr(start, end - start);
+		bool found = false;
+		for (int a = 0; a < n_algorithms; ++a) {
+			if (name == "all" || name == algorithms[a].name) {
+				algorithms[a].enabled = true;
+				found = true;
+			}
+		}
+		if (!found) return false;
+		start = end + 1;
+	}
+	return true;
+}
+
+// nearest rank percentile of sorted samples
+static double percentile(vector<double> const& sorted, double p) {
+	int rank = (int)(p / 100 * sorted.size() + 0.5);
+	return sorted[min(max(rank, 1), (int)sorted.size()) - 1];
+}
+
+static summary summarize(vector<double>& samples) {
+	std::sort(&samples[0], &samples[0] + samples.size());
+	double total = 0;
+	for (auto x : samples) total += x;
+	return {percentile(samples, 50), percentile(samples, 95), percentile(samples, 99),
+			total / samples.size(), samples.size() / (total / 1e6)};
+}
+
+// graph files hold 4 or 8 byte integer weights
+template <typename _Weight>
+static constexpr bool file_weight =
+	std::is_integral<_Weight>::value && (sizeof(_Weight) == 4 || sizeof(_Weight) == 8);
+
+template <typename _Weight>
+static basic_graph<_Weight> make_graph(options const& opt, std::default_random_engine& engine) {
+	if (opt.load) {
+		if constexpr (file_weight<_Weight>) return load_graph<_Weight>(opt.load);
+		else
+			throw generic_exception("graph files need int64, int32 or uint32 weights");
+	}
+	if (opt.parallel)
+		return graph_generator(opt.seed, opt.threads).make<_Weight>(opt.n, opt.type, opt.degree);
+	return basic_graph<_Weight>(opt.n, opt.type, engine, opt.degree);
+}
+
+template <typename _Heap>
+static int run(options const& opt) {
+	using weight = typename _Heap::value_type;
+	using clock = std::chrono::steady_clock;
+	auto us = [](clock::duration d) { return std::chrono::duration<double, std::micro>(d).count(); };
+
+	argmax_level() = opt.simd;
+	std::default_random_engine engine(opt.seed);
+	auto t0 = clock::now();
+	basic_graph<weight> G = make_graph<weight>(opt, engine);
+	double graph_us = us(clock::now() - t0);
+	double reorder_us = 0;
+	if (opt.order != vertex_order::none) {
+		t0 = clock::now();
+		G.reorder(opt.order);
+		reorder_us = us(clock::now() - t0);
+	}
+	if (opt.save) {
+		if constexpr (file_weight<weight>) save_graph(G, opt.save);
+		else
+			throw generic_exception("graph files need int64, int32 or uint32 weights");
+	}
+	if (G.num_vertices() < 2) {
+		std::cerr << "the graph needs at least 2 vertices" << std::endl;
+		return 2;
+	}
+	double oracle_us = 0;
+	basic_bottleneck_oracle<weight> oracle;
+	bool has_oracle = algorithms[5].enabled || algorithms[6].enabled || opt.save_oracle;
+	if (has_oracle) {
+		t0 = clock::now();
+		oracle = opt.load_oracle ? load_oracle<weight>(opt.load_oracle) : G.template oracle<_Heap>();
+		oracle_us = us(clock::now() - t0);
+		if (oracle.size() != G.num_vertices()) {
+			std::cerr << "the oracle file belongs to another graph" << std::endl;
+			return 2;
+		}
+		if (opt.save_oracle) save_oracle(oracle, opt.save_oracle);
+	}
+
+	std::uniform_int_distribution<> vertex_gen(0, G.num_vertices() - 1);
+	vector<pair<int, int>> queries(opt.queries);
+	for (int i = 0; i < opt.queries; ++i) {
+		int u = vertex_gen(engine), v = vertex_gen(engine);
+		while (v == u) v = vertex_gen(engine);
+		queries[i] = pair<int, int>(u, v);
+	}
+
+	auto answer = [&](int a, int s, int t) -> weight {
+		switch (a) {
+			case 0: return G.dijkstra_1(s, t).second;
+			case 1: return G.template dijkstra_2<_Heap>(s, t).second;
+			case 2: return G.template dijkstra_2<_Heap>(s, t, true).second;
+			case 3: return G.template widest_bidirectional<_Heap>(s, t).second;
+			case 4: return G.template kruskal<_Heap>(s, t).second;
+			case 5: return oracle.query(s, t);
+			default: return oracle.path(s, t).second;
+		}
+	};
+
+	summary results[n_algorithms];
+	// counters of the first trial, summed over the queries (built with -DGRAPH_STATS)
+	query_stats stats[n_algorithms];
+	// answers of the first algorithm, all others must match them
+	vector<weight> reference(opt.queries, 0);
+	int mismatches = 0, reference_algorithm = -1;
+	for (int a = 0; a < n_algorithms; ++a) {
+		if (!algorithms[a].enabled) continue;
+		for (int i = 0; i < opt.warmup; ++i)
+			answer(a, queries[i % opt.queries].first, queries[i % opt.queries].second);
+		vector<double> samples(opt.trials * opt.queries);
+		for (int trial = 0; trial < opt.trials; ++trial) {
+			for (int i = 0; i < opt.queries; ++i) {
+				query_stats::current().reset();
+				auto start = clock::now();
+				weight bw = answer(a, queries[i].first, queries[i].second);
+				samples[trial * opt.queries + i] = us(clock::now() - start);
+				if (trial > 0) continue;
+				stats[a] += query_stats::current();
+				if (reference_algorithm == -1) reference[i] = bw;
+				else if (reference[i] != bw) {
+					++mismatches;
+					std::cerr << "mismatch: " << algorithms[a].name << " gives " << bw << " for ("
+							  << queries[i].first << ", " << queries[i].second << "), "
+							  << algorithms[reference_algorithm].name << " gives " << reference[i]
+							  << std::endl;
+				}
+			}
+		}
+		if (reference_algorithm == -1) reference_algorithm = a;
+		results[a] = summarize(samples);
+	}
+
+	std::cout << "type " << opt.type << ", n " << G.num_vertices() << ", m " << G.num_edges()
+			  << ", seed " << opt.seed << ", generator "
+			  << (opt.load ? "file" : opt.parallel ? "parallel" : "serial")
+			  << ", heap " << opt.heap << ", weights " << opt.weights << ", order "
+			  << vertex_order_name(opt.order) << ", simd " << simd_level_name(opt.simd) << ", " << opt.queries
+			  << " queries x " << opt.trials << " trials" << std::endl;
+	std::cout << "graph construction: " << graph_us / 1000 << " ms" << std::endl;
+	if (opt.order != vertex_order::none)
+		std::cout << "reordering: " << reorder_us / 1000 << " ms" << std::endl;
+	if (has_oracle)
+		std::cout << (opt.load_oracle ? "oracle loading: " : "oracle construction: ")
+				  << oracle_us / 1000 << " ms" << std::endl;
+	std::cout << "algorithm   median_us   p95_us   p99_us   mean_us   queries/s" << std::endl;
+	for (int a = 0; a < n_algorithms; ++a) {
+		if (!algorithms[a].enabled) continue;
+		summary const& r = results[a];
+		std::cout << algorithms[a].name << "  " << r.median << "  " << r.p95 << "  " << r.p99 << "  "
+				  << r.mean << "  " << r.throughput << std::endl;
+	}
+	std::cout << (mismatches == 0 ? "all algorithms agree" : "ALGORITHMS DISAGREE") << std::endl;
+
+	if (opt.csv) {
+		std::ofstream out(opt.csv);
+		out << "type,n,m,degree,seed,heap,weights,order,simd,queries,trials,name,kind,median_us,p95_us,p99_us,"
+			   "mean_us,throughput_qps\n";
+		auto row = [&](const char* name, const char* kind, summary const& r) {
+			out << opt.type << "," << G.num_vertices() << "," << G.num_edges() << "," << opt.degree
+				<< "," << opt.seed << "," << opt.heap << "," << opt.weights << ","
+				<< vertex_order_name(opt.order) << "," << simd_level_name(opt.simd) << ","
+				<< opt.queries << "," << opt.trials << ","
+				<< name << "," << kind << "," << r.median << "," << r.p95 << "," << r.p99 << ","
+				<< r.mean << "," << r.throughput << "\n";
+		};
+		row("graph", "construction", {graph_us, graph_us, graph_us, graph_us, 0});
+		if (opt.order != vertex_order::none)
+			row("reorder", "construction", {reorder_us, reorder_us, reorder_us, reorder_us, 0});
+		if (has_oracle)
+			row("oracle", "construction", {oracle_us, oracle_us, oracle_us, oracle_us, 0});
+		for (int a = 0; a < n_algorithms; ++a)
+			if (algorithms[a].enabled) row(algorithms[a].name, "query", results[a]);
+	}
+	if (opt.json) {
+		std::ofstream out(opt.json);
+		out << "{\n  \"config\": {\"type\": " << opt.type << ", \"n\": " << G.num_vertices()
+			<< ", \"m\": " << G.num_edges() << ", \"degree\": " << opt.degree
+			<< ", \"seed\": " << opt.seed << ", \"heap\": \"" << opt.heap << "\", \"weights\": \""
+			<< opt.weights << "\", \"order\": \"" << vertex_order_name(opt.order) << "\", \"simd\": \""
+			<< simd_level_name(opt.simd) << "\", \"queries\": " << opt.queries << ", \"trials\": " << opt.trials
+			<< ", \"warmup\": " << opt.warmup << "},\n";
+		out << "  \"construction_us\": {\"graph\": " << graph_us;
+		if (opt.order != vertex_order::none) out << ", \"reorder\": " << reorder_us;
+		if (has_oracle) out << ", \"oracle\": " << oracle_us;
+		out << "},\n  \"mismatches\": " << mismatches << ",\n  \"results\": [";
+		bool first = true;
+		for (int a = 0; a < n_algorithms; ++a) {
+			if (!algorithms[a].enabled) continue;
+			summary const& r = results[a];
+			out << (first ? "\n" : ",\n") << "    {\"algorithm\": \"" << algorithms[a].name
+				<< "\", \"median_us\": " << r.median << ", \"p95_us\": " << r.p95
+				<< ", \"p99_us\": " << r.p99 << ", \"mean_us\": " << r.mean
+				<< ", \"throughput_qps\": " << r.throughput;
+#ifdef GRAPH_STATS
+			out << ", \"stats\": " << stats[a].json();
+#endif
+			out << "}";
+			first = false;
+		}
+		out << "\n  ]\n}\n";
+	}
+	return mismatches == 0 ? 0 : 1;
+}
+
+// run with the heap named by opt.heap over _Weight, which parse has checked
+template <typename _Weight>
+static int run_weights(options const& opt) {
+	std::string name = opt.heap;
+	if (name == "4ary") return run<dary_heap<_Weight, 4>>(opt);
+	if (name == "8ary") return run<dary_heap<_Weight, 8>>(opt);
+	if (name == "pairing") return run<pairing_heap<_Weight>>(opt);
+	if constexpr (std::is_integral<_Weight>::value)
+		if (name == "radix") return run<radix_heap<_Weight>>(opt);
+	return run<heap<_Weight>>(opt);
+}
+
+int main(int argc, char** argv) {
+	options opt;
+	if (!parse(argc, argv, opt)) {
+		usage(argv[0]);
+		return 2;
+	}
+	std::string weights = opt.weights;
+	try {
+		if (weights == "int32") return run_weights<int32_t>(opt);
+		if (weights == "uint32") return run_weights<uint32_t>(opt);
+		if (weights == "uint16") return run_weights<uint16_t>(opt);
+		if (weights == "double") return run_weights<double>(opt);
+		return run_weights<int64_t>(opt);
+	} catch (std::exception const& e) {
+		std::cerr << e.what() << std::endl;
+		return 2;
+	}
+}
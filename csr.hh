@@ -0,0 +1,121 @@
+#pragma once
+#include "shared_array.hh"
+#include "util.hh"
+#include "vector.hh"
+
+// Frozen adjacency in compressed sparse row form
+// The edges of vertex v are [offset[v], offset[v + 1]). Their endpoints and weights are
+// kept in two separate arrays, so a relaxation loop streams through both sequentially
+// instead of chasing one heap allocation per vertex. The arrays are frozen once built,
+// copies share them, and they can be borrowed from a mapped file as well.
+template <typename _Weight>
+class csr {
+   private:
+	int _n = 0;
+	shared_array<int> _offset;
+	shared_array<int> _target;
+	shared_array<_Weight> _weight;
+
+   public:
+	class iterator;
+	class range;
+	csr() {}
+	// freeze an adjacency list, keeping the order of every vertex's edges
+	template <typename _Adjacency>
+	csr(_Adjacency const& adj) : _n(adj.size()) {
+		vector<int> offset(_n + 1, 0);
+		for (int v = 0; v < _n; ++v) offset[v + 1] = offset[v] + adj[v].size();
+		vector<int> target(offset[_n]);
+		vector<_Weight> weight(offset[_n]);
+		for (int v = 0; v < _n; ++v) {
+			int e = offset[v];
+			for (auto edge : adj[v]) {
+				target[e] = edge.first;
+				weight[e++] = edge.second;
+			}
+		}
+		_offset = std::move(offset);
+		_target = std::move(target);
+		_weight = std::move(weight);
+	}
+	// build from an undirected edge list, every edge is stored in both directions
+	template <typename _Edges, typename _Weights>
+	csr(int n, _Edges const& edges, _Weights const& weights) : _n(n) {
+		int m = edges.size();
+		vector<int> offset(n + 1, 0), target(2 * m);
+		vector<_Weight> weight(2 * m);
+		for (int i = 0; i < m; ++i) {
+			++offset[edges[i].first + 1];
+			++offset[edges[i].second + 1];
+		}
+		for (int v = 0; v < _n; ++v) offset[v + 1] += offset[v];
+		vector<int> fill(_n);
+		for (int v = 0; v < _n; ++v) fill[v] = offset[v];
+		for (int i = 0; i < m; ++i) {
+			int u = edges[i].first, v = edges[i].second;
+			target[fill[u]] = v;
+			weight[fill[u]++] = weights[i];
+			target[fill[v]] = u;
+			weight[fill[v]++] = weights[i];
+		}
+		_offset = std::move(offset);
+		_target = std::move(target);
+		_weight = std::move(weight);
+	}
+	// use existing arrays as they are, offset has n + 1 entries
+	csr(int n, shared_array<int> offset, shared_array<int> target, shared_array<_Weight> weight)
+		: _n(n), _offset(std::move(offset)), _target(std::move(target)),
+		  _weight(std::move(weight)) {
+		assert(_offset.size() == (size_t)n + 1 && _target.size() == _weight.size() &&
+			   _target.size() == (size_t)_offset[n]);
+	}
+	int size() const { return _n; }
+	// number of stored (directed) edges
+	int edges() const { return _offset[_n]; }
+	int begin(int v) const { return _offset[v]; }
+	int end(int v) const { return _offset[v + 1]; }
+	int degree(int v) const { return _offset[v + 1] - _offset[v]; }
+	int target(int e) const { return _target[e]; }
+	_Weight weight(int e) const { return _weight[e]; }
+	// the raw arrays, e.g. to write them to a file
+	shared_array<int> const& offsets() const { return _offset; }
+	shared_array<int> const& targets() const { return _target; }
+	shared_array<_Weight> const& weights() const { return _weight; }
+	// edges of v as (target, weight) pairs, for range based loops
+	range operator[](int v) const;
+};
+
+template <typename _Weight>
+class csr<_Weight>::iterator {
+   public:
+	iterator(csr<_Weight> const* g, int e) : _g(g), _e(e) {}
+	pair<int, _Weight> operator*() const { return {_g->_target[_e], _g->_weight[_e]}; }
+	friend bool operator!=(iterator const& a, iterator const& b) { return a._e != b._e; }
+	friend bool operator==(iterator const& a, iterator const& b) { return a._e == b._e; }
+	iterator& operator++() {
+		++_e;
+		return *this;
+	}
+
+   private:
+	csr<_Weight> const* _g;
+	int _e;
+};
+
+template <typename _Weight>
+class csr<_Weight>::range {
+   public:
+	range(csr<_Weight> const* g, int v) : _g(g), _v(v) {}
+	iterator begin() const { return iterator(_g, _g->begin(_v)); }
+	iterator end() const { return iterator(_g, _g->end(_v)); }
+	int size() const { return _g->degree(_v); }
+
+   private:
+	csr<_Weight> const* _g;
+	int _v;
+};
+
+template <typename _Weight>
+typename csr<_Weight>::range csr<_Weight>::operator[](int v) const {
+	return range(this, v);
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "util.hh"
+#include "vector.hh"
+// Indexed d-ary max heap
+// Keys are stored next to their vertex in the heap array, so a sift only touches
+// one contiguous array, and with _D = 4 or 8 all children of a node share a cache line.
+// The tree is shallower than a binary heap, which makes increase_key cheaper.
+template <typename _Value, int _D = 4>
+class dary_heap {
+   public:
+	using value_type = _Value;
+
+   private:
+	// (key, vertex) in heap order
+	vector<pair<_Value, int>> H;
+	// position of every vertex in H, -1 if absent
+	vector<int> P;
+	int _size = 0;
+	int parent(int i) { return (i - 1) / _D; }
+	int child(int i) { return _D * i + 1; }
+	void _place(int i, pair<_Value, int> const& elem) {
+		H[i] = elem;
+		P[elem.second] = i;
+	}
+	void _sift_up(int i) {
+		pair<_Value, int> elem = H[i];
+		while (i != 0 && H[parent(i)].first < elem.first) {
+			_place(i, H[parent(i)]);
+			i = parent(i);
+		}
+		_place(i, elem);
+	}
+	void _sift_down(int i) {
+		pair<_Value, int> elem = H[i];
+		while (child(i) < _size) {
+			int first = child(i), last = min(first + _D, _size), max_child = first;
+			for (int c = first + 1; c < last; ++c)
+				if (H[c].first > H[max_child].first) max_child = c;
+			if (!(H[max_child].first > elem.first)) break;
+			_place(i, H[max_child]);
+			i = max_child;
+		}
+		_place(i, elem);
+	}
+
+   public:
+	dary_heap(int n) : H(n), P(n, -1) {}
+	template <typename _Data>
+	dary_heap(_Data const& data) : H(data.size()), P(data.size(), -1), _size(data.size()) {
+		for (int i = 0; i < _size; ++i) _place(i, pair<_Value, int>(data[i], i));
+		// from the parent of the last element down, nothing to do below two elements
+		if (_size >= 2)
+			for (int i = parent(_size - 1); i >= 0; --i) _sift_down(i);
+	}
+	pair<int, _Value> peek() { return {H[0].second, H[0].first}; }
+	pair<int, _Value> extract_max() {
+		pair<int, _Value> res = peek();
+		erase(res.first);
+		return res;
+	}
+	int size() { return this->_size; }
+	// empty the heap, keeping its storage
+	void reset() {
+		for (int i = 0; i < _size; ++i) P[H[i].second] = -1;
+		_size = 0;
+	}
+	void increase_key(int x, _Value value) {
+		H[P[x]].first = value;
+		_sift_up(P[x]);
+	}
+	void insert(int x, _Value value) {
+		++_size;
+		_place(_size - 1, pair<_Value, int>(value, x));
+		_sift_up(_size - 1);
+	}
+	void erase(int x) {
+		int index = P[x];
+		--_size;
+		if (index != _size) {
+			// move the last element into the hole, then restore the order either way
+			int moved = H[_size].second;
+			_place(index, H[_size]);
+			_sift_up(index);
+			if (P[moved] == index) _sift_down(index);
+		}
+		P[x] = -1;
+	}
+};
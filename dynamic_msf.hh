@@ -0,0 +1,236 @@
+#pragma once
+// only for std::sort
+#include <algorithm>
+// for int64_t
+#include <cstdint>
+// for std::numeric_limits
+#include <limits>
+
+#include "link_cut.hh"
+#include "union_find.hh"
+#include "util.hh"
+#include "vector.hh"
+
+// Maximum spanning forest of a changing graph
+// The forest lives in a link-cut tree in which every tree edge is a node of its own,
+// valued by its weight, between the nodes of its endpoints. Bottleneck queries are the
+// path minimum between two vertices.
+// - inserting an edge, or making one heavier, links it if it joins two trees, otherwise
+//   it replaces the lightest edge of the cycle it closes if that one is lighter:
+//   O(log n) amortized
+// - deleting a tree edge, or making one lighter, cuts it and searches the smaller of the
+//   two halves for the heaviest edge that joins them again: O(size + degrees of the
+//   smaller half)
+// - changes to non tree edges that do not make them heavier only update the edge
+// Edges are addressed by slots, which are reused after an edge is erased. Weights are
+// positive values of _Weight.
+template <typename _Weight = int64_t>
+class dynamic_msf {
+   private:
+	int _n = 0;
+	// vertex v is node v, edge slot e is node _n + e
+	link_cut_tree<_Weight> _lct;
+	vector<int> _u, _v;
+	vector<_Weight> _w;
+	vector<char> _tree, _used;
+	vector<int> _free;
+	// edges of every vertex as a list of half edges: 2e is e seen from _u[e], 2e + 1 from _v[e]
+	vector<int> _head, _next, _prev;
+	// scratch for the replacement search: side marks and the two search queues
+	vector<int> _mark, _queue[2];
+	int _stamp = 0;
+
+	int _other(int e, int x) const { return _u[e] == x ? _v[e] : _u[e]; }
+	void _attach(int h, int x) {
+		_prev[h] = -1;
+		_next[h] = _head[x];
+		if (_head[x] != -1) _prev[_head[x]] = h;
+		_head[x] = h;
+	}
+	void _detach(int h, int x) {
+		if (_prev[h] != -1) _next[_prev[h]] = _next[h];
+		else
+			_head[x] = _next[h];
+		if (_next[h] != -1) _prev[_next[h]] = _prev[h];
+	}
+	void _link(int e) {
+		_tree[e] = 1;
+		_lct.link(_u[e], _n + e);
+		_lct.link(_n + e, _v[e]);
+	}
+	void _cut(int e) {
+		_tree[e] = 0;
+		_lct.cut(_u[e], _n + e);
+		_lct.cut(_n + e, _v[e]);
+	}
+	// e is not in the forest: take it in if it joins two trees or beats the lightest edge
+	// of the cycle it closes
+	void _offer(int e) {
+		if (!_lct.connected(_u[e], _v[e])) {
+			_link(e);
+			return;
+		}
+		int f = _lct.path_min(_u[e], _v[e]) - _n;
+		if (_w[f] < _w[e]) {
+			_cut(f);
+			_link(e);
+		}
+	}
+	// e was just cut from the forest: find the heaviest other edge joining its two halves
+	// by growing both halves in turns until the smaller one is complete, -1 if none
+	int _replacement(int e) {
+		if (_stamp > INT32_MAX - 2) {
+			for (int x = 0; x < _n; ++x) _mark[x] = 0;
+			_stamp = 0;
+		}
+		_stamp += 2;
+		int size[2] = {1, 1}, done[2] = {0, 0};
+		_queue[0][0] = _u[e];
+		_queue[1][0] = _v[e];
+		_mark[_u[e]] = _stamp;
+		_mark[_v[e]] = _stamp + 1;
+		int side = -1;
+		while (side == -1) {
+			for (int s = 0; s < 2 && side == -1; ++s) {
+				if (done[s] == size[s]) {
+					side = s;
+					break;
+				}
+				int x = _queue[s][done[s]++];
+				for (int h = _head[x]; h != -1; h = _next[h]) {
+					int f = h >> 1, y = _other(f, x);
+					if (_tree[f] && _mark[y] != _stamp + s) {
+						_mark[y] = _stamp + s;
+						_queue[s][size[s]++] = y;
+					}
+				}
+			}
+		}
+		// every non tree edge leaving the complete half ends in the other one
+		int best = -1;
+		for (int i = 0; i < size[side]; ++i) {
+			int x = _queue[side][i];
+			for (int h = _head[x]; h != -1; h = _next[h]) {
+				int f = h >> 1;
+				if (f == e || _tree[f] || _mark[_other(f, x)] == _stamp + side) continue;
+				if (best == -1 || _w[f] > _w[best] || (_w[f] == _w[best] && f < best)) best = f;
+			}
+		}
+		return best;
+	}
+	// e left the forest: bring in its replacement if it is heavier than keep_weight, or
+	// put e back otherwise (pass keep_weight = 0 when e is being erased)
+	void _repair(int e, _Weight keep_weight) {
+		int f = _replacement(e);
+		if (f != -1 && _w[f] > keep_weight) _link(f);
+		else if (keep_weight > 0)
+			_link(e);
+	}
+
+   public:
+	dynamic_msf() {}
+	// n vertices without edges
+	dynamic_msf(int n) : _n(n), _lct(n), _head(n, -1), _mark(n, 0) {
+		_queue[0] = vector<int>(n);
+		_queue[1] = vector<int>(n);
+	}
+	// forest of an undirected edge list, edge i gets slot i
+	template <typename _Edges, typename _Weights>
+	dynamic_msf(int n, _Edges const& edges, _Weights const& weights) : dynamic_msf(n) {
+		int m = edges.size();
+		_lct = link_cut_tree<_Weight>(n + m);
+		_u = vector<int>(m);
+		_v = vector<int>(m);
+		_w = vector<_Weight>(m);
+		_tree = vector<char>(m, 0);
+		_used = vector<char>(m, 1);
+		_next = vector<int>(2 * m);
+		_prev = vector<int>(2 * m);
+		vector<int> order(m);
+		for (int e = 0; e < m; ++e) {
+			_u[e] = edges[e].first;
+			_v[e] = edges[e].second;
+			_w[e] = weights[e];
+			_lct.set_value(n + e, _w[e]);
+			_attach(2 * e, _u[e]);
+			_attach(2 * e + 1, _v[e]);
+			order[e] = e;
+		}
+		// Kruskal's, heavier edges first and ties by index as in graph
+		std::sort(order.data(), order.data() + m,
+				  [&](int a, int b) { return _w[a] > _w[b] || (_w[a] == _w[b] && a < b); });
+		union_find forest(n);
+		for (int i = 0; i < m; ++i)
+			if (forest.unify(_u[order[i]], _v[order[i]])) _link(order[i]);
+	}
+	int num_vertices() const { return _n; }
+	bool in_tree(int e) const { return _tree[e]; }
+	_Weight weight(int e) const { return _w[e]; }
+	// add the edge (u, v), returns its slot
+	int insert(int u, int v, _Weight w) {
+		assert(0 <= u && u < _n && 0 <= v && v < _n && u != v);
+		int e;
+		if (_free.size() > 0) {
+			e = _free[_free.size() - 1];
+			_free.pop_back();
+		} else {
+			e = _u.size();
+			_u.push_back(0);
+			_v.push_back(0);
+			_w.push_back(0);
+			_tree.push_back(0);
+			_used.push_back(0);
+			_next.push_back(-1);
+			_next.push_back(-1);
+			_prev.push_back(-1);
+			_prev.push_back(-1);
+			_lct.add(0);
+		}
+		_u[e] = u;
+		_v[e] = v;
+		_w[e] = w;
+		_used[e] = 1;
+		_lct.set_value(_n + e, w);
+		_attach(2 * e, u);
+		_attach(2 * e + 1, v);
+		_offer(e);
+		return e;
+	}
+	void erase(int e) {
+		assert(_used[e]);
+		if (_tree[e]) {
+			_cut(e);
+			_repair(e, 0);
+		}
+		_detach(2 * e, _u[e]);
+		_detach(2 * e + 1, _v[e]);
+		_used[e] = 0;
+		_free.push_back(e);
+	}
+	void set_weight(int e, _Weight w) {
+		assert(_used[e]);
+		_Weight old = _w[e];
+		_w[e] = w;
+		_lct.set_value(_n + e, w);
+		if (!_tree[e] && w > old) _offer(e);
+		else if (_tree[e] && w < old) {
+			_cut(e);
+			_repair(e, w);
+		}
+	}
+	bool connected(int s, int t) { return _lct.connected(s, t); }
+	// bandwidth of the widest path between s and t, 0 if they are not connected
+	_Weight bottleneck(int s, int t) {
+		if (s == t) return std::numeric_limits<_Weight>::max();
+		if (!_lct.connected(s, t)) return 0;
+		return _lct.value(_lct.path_min(s, t));
+	}
+	// vertices of the widest path from s to t through the forest, empty if not connected
+	vector<int> path(int s, int t) {
+		vector<int> ans;
+		if (!_lct.connected(s, t)) return ans;
+		for (int x : _lct.path(s, t))
+			if (x < _n) ans.push_back(x);
+		return ans;
+	}
+};
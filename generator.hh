@@ -0,0 +1,216 @@
+#pragma once
+// only for std::sort
+#include <algorithm>
+// for the block counter shared by the workers
+#include <atomic>
+// for uint64_t
+#include <cstdint>
+// only for std::mt19937_64 and the distributions
+#include <random>
+// for the worker threads
+#include <thread>
+
+#include "graph.hh"
+#include "hash_set.hh"
+#include "util.hh"
+#include "vector.hh"
+
+// Parallel generator of G1 / G2 style graphs
+// Vertices are split into fixed size blocks and every block draws from its own random
+// stream, seeded from the user's seed and the block number. Threads only decide which
+// block is processed when; each block's output is kept separately and merged in block
+// order. So a seed gives the same graph for any number of threads.
+//
+// G1: a random Hamiltonian cycle plus uniformly random extra edges, average degree 6.
+// G2: a random Hamiltonian cycle, then every vertex draws a wanted degree from
+//     [degree - 50, degree + 50] (degree = n / 5 by default) and proposes that many
+//     random neighbours. Merging follows the rules of the sequential generator: a
+//     proposal is kept while its proposer is below its wanted degree and both ends below
+//     degree + 50, so degrees fall in the same range with the same mean.
+// Unlike graph's own generator, nothing is retried from scratch: edges lost while merging
+// are proposed again in further rounds, until G1 reaches its average degree and every G2
+// vertex its wanted degree (or no neighbour is left to take it).
+class graph_generator {
+   private:
+	static constexpr int _block = 1 << 14;
+	uint64_t _seed;
+	int _threads;
+	// independent stream for (round, block)
+	std::mt19937_64 _stream(uint64_t round, uint64_t block) const {
+		uint64_t x = _seed ^ (round * 0x9e3779b97f4a7c15ULL) ^ (block * 0xc2b2ae3d27d4eb4fULL);
+		x ^= x >> 30;
+		x *= 0xbf58476d1ce4e5b9ULL;
+		x ^= x >> 27;
+		x *= 0x94d049bb133111ebULL;
+		x ^= x >> 31;
+		return std::mt19937_64(x);
+	}
+	// run fn(block) for every block on the worker threads
+	template <typename _Fn>
+	void _for_blocks(int blocks, _Fn fn) const {
+		std::atomic<int> next(0);
+		auto work = [&]() {
+			for (int b = next++; b < blocks; b = next++) fn(b);
+		};
+		int threads = min(_threads, blocks);
+		vector<std::thread> pool;
+		pool.reserve(threads);
+		for (int i = 1; i < threads; ++i) pool.push_back(std::thread(work));
+		work();
+		for (auto& th : pool) th.join();
+	}
+	// keep the candidates (proposer, neighbour) of every block that are new, in block order
+	// degree counts the edges of every vertex; neither end may have cap edges already, nor
+	// the proposer its wanted degree, if wanted is not empty
+	static void _merge(vector<vector<pair<int, int>>> const& cand,
+					   vector<vector<int64_t>> const& cand_weights, hash_set& seen,
+					   vector<int>& degree, int cap, vector<int> const& wanted,
+					   vector<pair<int, int>>& edges, vector<int64_t>& weights) {
+		for (int b = 0; b < (int)cand.size(); ++b) {
+			for (int i = 0; i < (int)cand[b].size(); ++i) {
+				int p = cand[b][i].first;
+				int u = min(p, cand[b][i].second), v = max(p, cand[b][i].second);
+				if (degree[u] >= cap || degree[v] >= cap) continue;
+				if (wanted.size() > 0 && degree[p] >= wanted[p]) continue;
+				if (seen.insert((uint64_t)u << 32 | (uint32_t)v)) {
+					edges.push_back(pair<int, int>(u, v));
+					weights.push_back(cand_weights[b][i]);
+					++degree[u];
+					++degree[v];
+				}
+			}
+		}
+	}
+
+   public:
+	// threads = 0 uses every hardware thread
+	graph_generator(uint64_t seed, int threads = 0)
+		: _seed(seed),
+		  _threads(threads > 0 ? threads : max(1, (int)std::thread::hardware_concurrency())) {}
+	// degree is the average degree, 0 keeps the default of the type (6 for G1, n / 5 for G2)
+	// weights are drawn from [1, max_weight]
+	void generate(int n, int type, int degree, vector<pair<int, int>>& edges,
+				  vector<int64_t>& weights, int64_t max_weight = INT32_MAX) const {
+		assert(n >= 3 && (type == 1 || type == 2));
+		if (degree <= 0) degree = type == 1 ? 6 : n / 5;
+		int blocks = (n + _block - 1) / _block;
+		int lo = max(degree - 50, 2), hi = max(degree + 50, 2);
+		// no more edges than the complete graph has, or the rounds below would never end
+		size_t target = min((size_t)degree * n / 2, (size_t)n * (n - 1) / 2);
+		// G2 degrees stay below hi, as in graph's own generator
+		int cap = type == 2 ? hi : n;
+		size_t capacity = type == 1 ? target : min((size_t)hi * n / 2, (size_t)n * (n - 1) / 2);
+		edges = vector<pair<int, int>>();
+		weights = vector<int64_t>();
+		edges.reserve(capacity);
+		weights.reserve(capacity);
+		hash_set seen(capacity);
+		vector<int> degree_of(n, 0);
+
+		// the cycle visits the vertices in order of random keys
+		vector<pair<uint64_t, int>> order(n);
+		vector<int64_t> cycle_weights(n);
+		_for_blocks(blocks, [&](int b) {
+			std::mt19937_64 rng = _stream(0, b);
+			std::uniform_int_distribution<int64_t> weight_gen(1, max_weight);
+			for (int v = b * _block; v < min(n, (b + 1) * _block); ++v) {
+				order[v] = pair<uint64_t, int>(rng(), v);
+				cycle_weights[v] = weight_gen(rng);
+			}
+		});
+		std::sort(&order[0], &order[0] + n);
+		for (int i = 0; i < n; ++i) {
+			int u = order[i].second, v = order[(i + 1) % n].second;
+			seen.insert((uint64_t)min(u, v) << 32 | (uint32_t)max(u, v));
+			edges.push_back(pair<int, int>(min(u, v), max(u, v)));
+			weights.push_back(cycle_weights[u]);
+			++degree_of[u];
+			++degree_of[v];
+		}
+
+		vector<vector<pair<int, int>>> cand(blocks);
+		vector<vector<int64_t>> cand_weights(blocks);
+		uint64_t round = 1;
+		if (type == 2) {
+			vector<int> wanted(n);
+			_for_blocks(blocks, [&](int b) {
+				std::mt19937_64 rng = _stream(round, b);
+				std::uniform_int_distribution<> degree_gen(lo, hi), vertex_gen(0, n - 1);
+				std::uniform_int_distribution<int64_t> weight_gen(1, max_weight);
+				int first = b * _block, last = min(n, (b + 1) * _block);
+				cand[b].reserve((size_t)hi * (last - first));
+				cand_weights[b].reserve((size_t)hi * (last - first));
+				for (int u = first; u < last; ++u) {
+					wanted[u] = degree_gen(rng);
+					// the cycle already gives every vertex 2 neighbours
+					for (int k = 2; k < wanted[u]; ++k) {
+						int v = vertex_gen(rng);
+						if (v == u) continue;
+						cand[b].push_back(pair<int, int>(u, v));
+						cand_weights[b].push_back(weight_gen(rng));
+					}
+				}
+			});
+			_merge(cand, cand_weights, seen, degree_of, cap, wanted, edges, weights);
+			// vertices left below their degree by duplicates and full neighbours propose
+			// the missing edges to vertices below hi, until a round adds nothing
+			for (size_t before = 0; before != edges.size();) {
+				before = edges.size();
+				++round;
+				vector<int> open;
+				for (int v = 0; v < n; ++v)
+					if (degree_of[v] < cap) open.push_back(v);
+				if (open.size() < 2) break;
+				_for_blocks(blocks, [&](int b) {
+					std::mt19937_64 rng = _stream(round, b);
+					std::uniform_int_distribution<> open_gen(0, open.size() - 1);
+					std::uniform_int_distribution<int64_t> weight_gen(1, max_weight);
+					cand[b].clear();
+					cand_weights[b].clear();
+					for (int u = b * _block; u < min(n, (b + 1) * _block); ++u) {
+						for (int k = degree_of[u]; k < wanted[u]; ++k) {
+							int v = open[open_gen(rng)];
+							if (v == u) continue;
+							cand[b].push_back(pair<int, int>(u, v));
+							cand_weights[b].push_back(weight_gen(rng));
+						}
+					}
+				});
+				_merge(cand, cand_weights, seen, degree_of, cap, wanted, edges, weights);
+			}
+			return;
+		}
+		// G1 edges are uniformly random; every round splits the missing ones over the blocks
+		// and those lost as duplicates are made up by the next
+		for (; edges.size() < target; ++round) {
+			size_t missing = target - edges.size();
+			_for_blocks(blocks, [&](int b) {
+				std::mt19937_64 rng = _stream(round, b);
+				std::uniform_int_distribution<> vertex_gen(0, n - 1);
+				std::uniform_int_distribution<int64_t> weight_gen(1, max_weight);
+				size_t quota = missing * (b + 1) / blocks - missing * b / blocks;
+				cand[b].clear();
+				cand_weights[b].clear();
+				cand[b].reserve(quota);
+				cand_weights[b].reserve(quota);
+				while (cand[b].size() < quota) {
+					int u = vertex_gen(rng), v = vertex_gen(rng);
+					if (u == v) continue;
+					cand[b].push_back(pair<int, int>(u, v));
+					cand_weights[b].push_back(weight_gen(rng));
+				}
+			});
+			_merge(cand, cand_weights, seen, degree_of, cap, vector<int>(), edges, weights);
+		}
+	}
+	// generate and freeze a graph, with the weights basic_graph<_Weight> would draw itself
+	template <typename _Weight = graph::weight_type>
+	basic_graph<_Weight> make(int n, int type, int degree = 0) const {
+		vector<pair<int, int>> edges;
+		vector<int64_t> drawn;
+		generate(n, type, degree, edges, drawn, basic_graph<_Weight>::max_generated_weight());
+		vector<_Weight> weights(drawn.size());
+		for (size_t i = 0; i < drawn.size(); ++i) weights[i] = drawn[i];
+		return basic_graph<_Weight>(n, std::move(edges), std::move(weights));
+	}
+};
@@ -1,30 +1,118 @@
 #pragma once
-// only for std::shuffle
+// only for std::shuffle and std::sort
 #include <algorithm>
+// for memcpy
+#include <cstring>
 // for std::cout
 #include <iostream>
+// for std::numeric_limits
+#include <limits>
 // only for std::uniform_int_distribution<> and std::default_random_engine
 #include <random>
+// for the parallel maximum spanning tree
+#include <thread>
+// for the weight type checks
+#include <type_traits>
 
+#include "argmax.hh"
+#include "csr.hh"
+#include "dary_heap.hh"
+#include "dynamic_msf.hh"
+#include "hash_map.hh"
+#include "hash_set.hh"
 #include "heap.hh"
-#include "map.hh"
+#include "max_flow.hh"
+#include "oracle.hh"
+#include "pairing_heap.hh"
 #include "queue.hh"
+#include "radix_heap.hh"
+#include "radix_sort.hh"
+#include "reorder.hh"
+#include "shared_array.hh"
+#include "stats.hh"
+#include "union_find.hh"
 #include "util.hh"
 #include "vector.hh"
+#include "workspace.hh"
+
+// Graph with edge weights of type _Weight
+// Weights may be of any arithmetic type except unsigned 64 bit integers, e.g. uint16_t or
+// uint32_t to halve the memory the searches stream through, or double for fractional
+// capacities. Every weight must be positive: a missing path is 0 wide and the path from a
+// vertex to itself max_width wide. Vertices are int ids in every instance.
+// reorder() renumbers the vertices for locality; ids passed to and returned by the public
+// methods stay the caller's, only the arrays behind them are laid out anew.
+template <typename _Weight = int64_t>
+class basic_graph {
+	static_assert(std::is_arithmetic<_Weight>::value &&
+					  (std::is_signed<_Weight>::value || sizeof(_Weight) < 8),
+				  "weights must fit the 64 bit keys of the max fringe scan");
+
+   public:
+	using weight_type = _Weight;
+	// bandwidth of the path from a vertex to itself, wider than every edge
+	static constexpr _Weight max_width = std::numeric_limits<_Weight>::max();
+	// flows add up many weights, so integral weights flow in 64 bits
+	using flow_type =
+		typename std::conditional<std::is_floating_point<_Weight>::value, _Weight, int64_t>::type;
+	// generated weights are drawn from [1, INT32_MAX], or [1, max_width] if it is smaller
+	static int64_t max_generated_weight() {
+		if constexpr (std::is_integral<_Weight>::value)
+			return min((int64_t)INT32_MAX, (int64_t)max_width);
+		else
+			return INT32_MAX;
+	}
+	class widest_tree;
 
-class graph {
    private:
 	std::default_random_engine _engine;
-	vector<vector<pair<int, int64_t>>> G;
+	// degree of every vertex, only used while the graph is generated
+	vector<int> _gen_degree;
+	// edge list being generated or changed, frozen into edge_index / weights by commit()
+	vector<pair<int, int>> _new_edges;
+	vector<_Weight> _new_weights;
+	// the edge list has changes that are not in the frozen arrays yet
+	bool _changed = false;
+	// edge ids by endpoints, built by the first change
+	hash_map<int> _edge_ids;
+	bool _indexed = false;
+	// spanning forest kept up to date with the changes, and the slot of every edge in it
+	dynamic_msf<_Weight> _forest;
+	vector<int> _forest_slot;
+	bool _tracking = false;
+	// frozen adjacency used by all queries
+	csr<_Weight> _adj;
+	// edge ids in Kruskal's order and those of every vertex heaviest first, built by the
+	// first query that needs them
+	vector<int> _by_weight;
+	bool _has_order = false;
+	csr<int> _incident;
+	bool _has_incident = false;
 	std::uniform_int_distribution<> _vertex_gen;
 	std::uniform_int_distribution<int64_t> _weight_gen;
-	vector<pair<int, int>> edge_index;
-	vector<int64_t> weights;
-	class dsu;
+	// frozen edge list, edge i is edge_index[i] = (u, v) with u < v and weight weights[i]
+	shared_array<pair<int, int>> edge_index;
+	shared_array<_Weight> weights;
+	// after reorder(), _label[v] is the caller's id of vertex v and _rank[x] the vertex of
+	// the caller's id x; both are empty while the ids are the caller's own
+	shared_array<int> _label, _rank;
 	int _n = 0;
 	int _m = 0;
+	// target average degree of the generated graph
+	int _degree = 0;
+	// (u, v) with u < v packed into the key of the edge set
+	static uint64_t _edge_key(int u, int v) { return (uint64_t)u << 32 | (uint32_t)v; }
+	// add the new edge (u, v), u < v, to the edge list
+	void _add_edge(int u, int v, _Weight w, hash_set& edges) {
+		++_gen_degree[u];
+		++_gen_degree[v];
+		_m += 2;
+		edges.insert(_edge_key(u, v));
+		_new_edges.push_back({u, v});
+		_new_weights.push_back(w);
+	}
 	// create a graph with a single cycle using a permutation
-	void _create_with_cycle(map<pair<int, int>, int64_t>& edges) {
+	void _create_with_cycle(hash_set& edges) {
 		vector<int> permutation(_n);
 		for (int i = 0; i < _n; ++i) permutation[i] = i;
 
@@ -33,34 +121,29 @@ class graph {
 		for (int i = 0; i < _n; ++i) {
 			int u = min(permutation[i], permutation[(i + 1) % _n]);
 			int v = max(permutation[i], permutation[(i + 1) % _n]);
-			int w = _weight_gen(_engine);
+			int64_t w = _weight_gen(_engine);
 			if (u > v) std::swap(u, v);
-			G[u].push_back({v, w});
-			G[v].push_back({u, w});
-			_m += 2;
-			edges[{u, v}] = w;
+			_add_edge(u, v, w, edges);
 		}
 	}
 	// In the first type, we sample pairs of vertices randomly and assign weights
-	void _create_1(map<pair<int, int>, int64_t>& edges) {
+	void _create_1(hash_set& edges) {
 		_create_with_cycle(edges);
-		while (edges.size() < 3 * _n) {
+		// no more edges than the complete graph has, or this would never end
+		size_t target = min((size_t)_degree * _n / 2, (size_t)_n * (_n - 1) / 2);
+		while (edges.size() < target) {
 			int u = _vertex_gen(_engine);
 			int v = _vertex_gen(_engine);
 			if (u > v) std::swap(u, v);
 			int64_t w = _weight_gen(_engine);
-			if (u != v && !edges.search({u, v})) {
-				G[u].push_back({v, w});
-				G[v].push_back({u, w});
-				_m += 2;
-				edges[{u, v}] = w;
-			}
+			if (u != v && !edges.contains(_edge_key(u, v))) _add_edge(u, v, w, edges);
 		}
 	}
 	// In the second type, we sample number of neighbours and neighbours for each vertex
-	int _create_2(map<pair<int, int>, int64_t>& edges) {
+	int _create_2(hash_set& edges) {
 		_create_with_cycle(edges);
-		int lo = (_n / 5 - 50), hi = (_n / 5 + 50);
+		// no vertex can have more than n - 1 neighbours
+		int hi = min(_degree + 50, _n - 1), lo = min(_degree - 50, hi);
 		std::uniform_int_distribution<> _n_gen(max(lo, 0), hi);
 		vector<int> n_neighs(_n), permutation(_n);
 		for (int i = 0; i < _n; ++i) {
@@ -71,51 +154,154 @@ class graph {
 			std::shuffle(permutation.begin(), permutation.end(), _engine);
 			int flag = -1;
 			for (int i = 0; i < _n && flag == -1; ++i)
-				if (G[permutation[i]].size() < n_neighs[permutation[i]]) flag = i;
+				if (_gen_degree[permutation[i]] < n_neighs[permutation[i]]) flag = i;
 			if (flag == -1) break;
 			int u = permutation[flag];
-			for (int j = 1; j < _n && G[u].size() < n_neighs[u]; ++j) {
+			for (int j = 1; j < _n && _gen_degree[u] < n_neighs[u]; ++j) {
 				int v = permutation[(flag + j) % _n];
-				if (G[v].size() < hi && u != v && !edges.search({min(u, v), max(u, v)})) {
+				if (_gen_degree[v] < hi && u != v && !edges.contains(_edge_key(min(u, v), max(u, v)))) {
 					int64_t w = _weight_gen(_engine);
-					G[u].push_back({v, w});
-					G[v].push_back({u, w});
-					_m += 2;
-					edges[{min(u, v), max(u, v)}] = w;
+					_add_edge(min(u, v), max(u, v), w, edges);
 				}
 			}
-			if (G[u].size() < n_neighs[u]) return -1;
+			if (_gen_degree[u] < n_neighs[u]) return -1;
 		}
 		return 0;
 	}
-	// find max fringer using a linear scan (without heap)
-	int _get_max_fringer(vector<int> const& status, vector<int64_t> const& b_width) {
-		int64_t max_bw = 0, max_fringer = -1;
+	// print degree statistics of the finished graph
+	void _report() {
+		int min_deg = INT32_MAX, max_deg = 0;
+		int64_t sum_deg = 0;
 		for (int i = 0; i < _n; ++i) {
-			if (status[i] == 1 && max_bw < b_width[i]) {
-				max_bw = b_width[i];
-				max_fringer = i;
-			}
+			min_deg = min(min_deg, _adj.degree(i));
+			max_deg = max(max_deg, _adj.degree(i));
+			sum_deg += _adj.degree(i);
 		}
-		return max_fringer;
+		std::cout << "Graph has been created" << std::endl;
+		std::cout << "Min Degree: " << min_deg << " Max Degree: " << max_deg
+				  << " Avg Degree: " << (double)(sum_deg) / _n << std::endl;
+	}
+	// copy the frozen edge list before its first change
+	void _thaw() {
+		if (_changed) return;
+		int m = edge_index.size();
+		_new_edges = vector<pair<int, int>>(m);
+		_new_weights = vector<_Weight>(m);
+		for (int i = 0; i < m; ++i) {
+			_new_edges[i] = edge_index[i];
+			_new_weights[i] = weights[i];
+		}
+		_changed = true;
+	}
+	void _index_edges() {
+		if (_indexed) return;
+		int m = _m / 2;
+		_edge_ids.reserve(m);
+		// of parallel edges (only found in imported graphs) the first one is indexed
+		for (int i = 0; i < m; ++i) {
+			pair<int, int> e = _changed ? _new_edges[i] : edge_index[i];
+			if (!_edge_ids.contains(_edge_key(e.first, e.second)))
+				_edge_ids.insert(_edge_key(e.first, e.second), i);
+		}
+		_indexed = true;
+	}
+	// order preserving key of a non negative weight for the max fringe scan, the bits of a
+	// non negative double compare like the double
+	static int64_t _fringe_key(_Weight w) {
+		if constexpr (std::is_floating_point<_Weight>::value) {
+			double d = w;
+			int64_t bits;
+			std::memcpy(&bits, &d, sizeof(bits));
+			return bits;
+		} else
+			return (int64_t)w;
+	}
+	// find max fringer using a linear scan (without heap)
+	// fringe holds the bandwidth of every fringer and -1 for the other vertices, so the scan
+	// is a branch free SIMD maximum
+	int _get_max_fringer(vector<int64_t> const& fringe) { return argmax(fringe.data(), _n); }
+	// caller's id to vertex and back, -1 stays -1
+	int _in(int x) const { return _rank.size() == 0 || x < 0 ? x : _rank[x]; }
+	int _out(int v) const { return _label.size() == 0 || v < 0 ? v : _label[v]; }
+	// a path and its bandwidth in the caller's ids
+	pair<vector<int>, _Weight> _out(pair<vector<int>, _Weight> ans) const {
+		if (_label.size() > 0)
+			for (int& v : ans.first) v = _label[v];
+		return ans;
+	}
+	// a spanning tree in the caller's ids, e.g. for an oracle answering in them
+	csr<_Weight> _out(csr<_Weight> tree) const {
+		if (_label.size() == 0) return tree;
+		vector<pair<int, int>> edges;
+		vector<_Weight> edge_weights;
+		for (int v = 0; v < _n; ++v)
+			for (auto edge : tree[v])
+				if (v < edge.first) {
+					edges.push_back({_label[v], _label[edge.first]});
+					edge_weights.push_back(edge.second);
+				}
+		return csr<_Weight>(_n, edges, edge_weights);
+	}
+	int _find_edge(int u, int v) {
+		_index_edges();
+		int* id = _edge_ids.find(_edge_key(min(u, v), max(u, v)));
+		return id == nullptr ? -1 : *id;
+	}
+	// weight of the widest edge between u and v, 0 if there is none
+	_Weight _edge_width(int u, int v) const {
+		_Weight w = 0;
+		for (auto edge : _adj[u])
+			if (edge.first == v) w = max(w, (_Weight)edge.second);
+		return w;
 	}
-	// construct path by using dad array
-	vector<int> _retrace_path(vector<int> const& dad, const int s, const int t) {
+	// construct path by using dad array, empty if t was not reached
+	static vector<int> _retrace_path(vector<int> const& dad, const int s, const int t) {
 		vector<int> ans;
+		if (dad[t] == -1) return ans;
 		for (int c = t; c != s; c = dad[c]) { ans.push_back(c); }
 		ans.push_back(s);
 		reverse(ans.begin(), ans.end());
 		return ans;
 	}
+	// Dijkstra with heap on the scratch arrays of ws, which must have been reset
+	template <typename _Heap>
+	void _widest(const int s, const int t, query_workspace<_Heap>& ws) const;
+	// widest_from in the graph's own ids
+	template <typename _Heap>
+	widest_tree _widest_from(const int s, const int t = -1);
+	// Kruskal's algorithm, returns the maximum spanning tree
+	csr<_Weight> _max_spanning_tree();
+	// Filter-Kruskal on multiple threads, returns the same tree as _max_spanning_tree
+	csr<_Weight> _max_spanning_tree_parallel(int threads);
+	// edge a comes before edge b in Kruskal's order (heavier first, ties by index)
+	bool _heavier(int a, int b) const {
+		return weights[a] > weights[b] || (weights[a] == weights[b] && a < b);
+	}
+	// edge ids in Kruskal's order, radix sorted by the first call after a change
+	vector<int> const& _kruskal_order() {
+		if (!_has_order) {
+			int m = _m / 2;
+			vector<uint64_t> keys(m);
+			// the complement sorts heaviest first, the stable sort keeps ties by index
+			for (int e = 0; e < m; ++e) keys[e] = ~radix_key(weights[e]);
+			_by_weight = radix_order(std::move(keys));
+			_has_order = true;
+		}
+		return _by_weight;
+	}
+	void _filter_kruskal(vector<int>& ids, vector<int>& buf, int lo, int hi,
+						 concurrent_union_find& forest, vector<int>& chosen, int threads);
 	// BFS to find path in MST from s to t
-	pair<vector<int>, int64_t> _bfs(vector<vector<pair<int, int64_t>>> const& tree, const int s,
-									const int t) {
+	pair<vector<int>, _Weight> _bfs(csr<_Weight> const& tree, const int s, const int t) {
+		STAT_TIMER(timer);
 		vector<int> dad(_n, -1);
-		vector<int64_t> b_width(_n, 0);
-		queue<int> q;
+		vector<_Weight> b_width(_n, 0);
+		ring_queue<int> q(_n);
 		dad[s] = s;
-		b_width[s] = INT32_MAX;
+		b_width[s] = max_width;
+		STAT_LAP(timer, setup);
 		q.push(s);
+		STAT_INC(queue_pushes);
 		while (q.size() > 0) {
 			int u = q.pop();
 			if (u == t) break;
@@ -124,73 +310,222 @@ class graph {
 					dad[e.first] = u;
 					b_width[e.first] = min(b_width[u], e.second);
 					q.push(e.first);
+					STAT_INC(queue_pushes);
 				}
 			}
 		}
-		pair<vector<int>, int64_t> ans(_retrace_path(dad, s, t), b_width[t]);
+		STAT_LAP(timer, bfs);
+		pair<vector<int>, _Weight> ans(_retrace_path(dad, s, t), b_width[t]);
+		STAT_LAP(timer, output);
 		return ans;
 	}
 
    public:
-	graph(int n, int type, std::default_random_engine& _engine)
-		: G(n), _engine(_engine), _vertex_gen(0, n - 1), _weight_gen(1, INT32_MAX), _n(n) {
-		map<pair<int, int>, int64_t> edges;
+	// degree is the average degree to generate, 0 keeps the default of the type
+	// (6 for G1, n / 5 for G2)
+	basic_graph(int n, int type, std::default_random_engine& _engine, int degree = 0)
+		: _engine(_engine), _gen_degree(n, 0), _vertex_gen(0, n - 1), _weight_gen(1, max_generated_weight()), _n(n) {
 		if (type == 1) {
+			_degree = degree > 0 ? degree : 6;
+			hash_set edges((size_t)_degree * n / 2 + n);
+			_new_edges.reserve((size_t)_degree * n / 2 + n);
+			_new_weights.reserve((size_t)_degree * n / 2 + n);
 			_create_1(edges);
 		} else {
 			assert(type == 2);
-			for (int i = 0; i < n; ++i) G[i].reserve(n / 5);
-			while (true) {
-				int res = _create_2(edges);
-				if (res == 0) break;
-				else
-					edges = decltype(edges)();	// reset
+			_degree = degree > 0 ? degree : n / 5;
+			hash_set edges((size_t)(_degree + 50) * n / 2 + n);
+			_new_edges.reserve((size_t)(_degree + 50) * n / 2 + n);
+			_new_weights.reserve((size_t)(_degree + 50) * n / 2 + n);
+			while (_create_2(edges) != 0) {
+				// start over from an empty graph
+				for (int i = 0; i < n; ++i) _gen_degree[i] = 0;
+				edges.clear();
+				_new_edges.clear();
+				_new_weights.clear();
+				_m = 0;
 			}
 		}
-		edge_index = vector<pair<int, int>>(_m / 2);
-		weights = vector<int64_t>(_m / 2);
-		assert(edges.size() == _m / 2);
-		auto it = edges.begin();
-		for (int count = 0; count < _m / 2; ++count, ++it) {
-			edge_index[count] = it->first;
-			weights[count] = it->second;
-		}
-		assert(!it);
-		int min_deg = INT32_MAX, sum_deg = 0, max_deg = 0;
-		for (int i = 0; i < n; ++i) {
-			min_deg = min(min_deg, (int)G[i].size());
-			max_deg = max(max_deg, (int)G[i].size());
-			sum_deg += G[i].size();
+		assert((int)_new_edges.size() == _m / 2);
+		// the edge list keeps every vertex's edges in the order they were added
+		_adj = csr<_Weight>(_n, _new_edges, _new_weights);
+		_gen_degree = vector<int>();
+		edge_index = std::move(_new_edges);
+		weights = std::move(_new_weights);
+		_report();
+	}
+	// graph with n vertices from an undirected edge list, e.g. made by graph_generator
+	basic_graph(int n, vector<pair<int, int>> edges, vector<_Weight> edge_weights)
+		: _vertex_gen(0, n - 1), _weight_gen(1, max_generated_weight()), _n(n), _m(2 * edges.size()) {
+		assert(edges.size() == edge_weights.size());
+		for (auto e : edges) assert(e.first != e.second && 0 <= min(e.first, e.second) &&
+									max(e.first, e.second) < n);
+		_degree = _m / max(n, 1);
+		_adj = csr<_Weight>(_n, edges, edge_weights);
+		edge_index = std::move(edges);
+		weights = std::move(edge_weights);
+		_report();
+	}
+	// graph over already frozen arrays, e.g. mapped from a file by load_graph
+	// nothing is copied or checked beyond the sizes; labels and ranks are those of a
+	// reordered graph (vertex_labels(), vertex_ranks()), or empty
+	basic_graph(csr<_Weight> adj, shared_array<pair<int, int>> edges,
+				shared_array<_Weight> edge_weights, shared_array<int> labels = shared_array<int>(),
+				shared_array<int> ranks = shared_array<int>())
+		: _adj(std::move(adj)), _vertex_gen(0, max(_adj.size() - 1, 0)), _weight_gen(1, max_generated_weight()),
+		  edge_index(std::move(edges)), weights(std::move(edge_weights)), _label(std::move(labels)),
+		  _rank(std::move(ranks)), _n(_adj.size()), _m(2 * edge_index.size()) {
+		assert(edge_index.size() == weights.size() && _adj.edges() == _m);
+		assert(_label.size() == _rank.size() && (_label.size() == 0 || _label.size() == (size_t)_n));
+		_degree = _m / max(_n, 1);
+	}
+	int num_vertices() const { return _n; }
+	// frozen adjacency and edge list, e.g. to write them to a file
+	csr<_Weight> const& adjacency() const {
+		assert(!_changed);
+		return _adj;
+	}
+	shared_array<pair<int, int>> const& edge_list() const {
+		assert(!_changed);
+		return edge_index;
+	}
+	shared_array<_Weight> const& edge_weights() const {
+		assert(!_changed);
+		return weights;
+	}
+	// the caller's id of every vertex of the arrays above and the reverse, empty if the
+	// graph was never reordered
+	shared_array<int> const& vertex_labels() const { return _label; }
+	shared_array<int> const& vertex_ranks() const { return _rank; }
+	bool reordered() const { return _label.size() > 0; }
+	// Renumber the vertices in the given order (reorder.hh) so that neighbours sit close
+	// together in every per-vertex array, O(n + m) besides computing the order. Queries
+	// keep taking and returning the caller's ids. Best called once after building the
+	// graph; spanning trees and oracles built before stay valid, widest_trees do too.
+	void reorder(vertex_order how);
+	// Changing the graph
+	// Changes go to the edge list at once. The frozen adjacency used by the searches is
+	// rebuilt from it in O(n + m) by commit(), which every query that is not const calls
+	// first, so a batch of changes costs one rebuild. Call commit() before handing the
+	// graph to const queries (widest, query_server, save_graph).
+	// Edges are addressed by their endpoints; removing one moves the last edge to its id.
+	// id of the edge (u, v), -1 if there is none
+	int find_edge(int u, int v) { return _find_edge(_in(u), _in(v)); }
+	// returns the id of the new edge
+	int add_edge(int u, int v, _Weight w) {
+		assert(0 <= min(u, v) && max(u, v) < _n && u != v && w > 0);
+		u = _in(u);
+		v = _in(v);
+		assert(_find_edge(u, v) == -1);
+		if (u > v) std::swap(u, v);
+		_thaw();
+		int id = _new_edges.size();
+		_new_edges.push_back({u, v});
+		_new_weights.push_back(w);
+		_edge_ids.insert(_edge_key(u, v), id);
+		_m += 2;
+		if (_tracking) _forest_slot.push_back(_forest.insert(u, v, w));
+		return id;
+	}
+	void remove_edge(int u, int v) {
+		u = _in(u);
+		v = _in(v);
+		int id = _find_edge(u, v);
+		assert(id != -1);
+		_thaw();
+		int last = _new_edges.size() - 1;
+		_edge_ids.erase(_edge_key(min(u, v), max(u, v)));
+		if (_tracking) {
+			_forest.erase(_forest_slot[id]);
+			_forest_slot[id] = _forest_slot[last];
+			_forest_slot.pop_back();
 		}
-		std::cout << "Graph has been created" << std::endl;
-		std::cout << "Min Degree: " << min_deg << " Max Degree: " << max_deg
-				  << " Avg Degree: " << (double)(sum_deg) / n << std::endl;
+		if (id != last) {
+			_new_edges[id] = _new_edges[last];
+			_new_weights[id] = _new_weights[last];
+			_edge_ids.insert(_edge_key(_new_edges[id].first, _new_edges[id].second), id);
+		}
+		_new_edges.pop_back();
+		_new_weights.pop_back();
+		_m -= 2;
+	}
+	void set_weight(int u, int v, _Weight w) {
+		int id = _find_edge(_in(u), _in(v));
+		assert(id != -1 && w > 0);
+		_thaw();
+		_new_weights[id] = w;
+		if (_tracking) _forest.set_weight(_forest_slot[id], w);
 	}
+	// fold the changes into the frozen adjacency and edge list
+	void commit() {
+		if (!_changed) return;
+		_adj = csr<_Weight>(_n, _new_edges, _new_weights);
+		edge_index = std::move(_new_edges);
+		weights = std::move(_new_weights);
+		_degree = _m / max(_n, 1);
+		_by_weight = vector<int>();
+		_has_order = false;
+		_incident = csr<int>();
+		_has_incident = false;
+		_changed = false;
+	}
+	// Keep a maximum spanning forest up to date with every change (see dynamic_msf), so
+	// bottleneck queries need no rebuild. Built once in O(m log m).
+	void track_spanning_forest() {
+		if (_tracking) return;
+		int m = _m / 2;
+		_forest = _changed ? dynamic_msf<_Weight>(_n, _new_edges, _new_weights)
+						   : dynamic_msf<_Weight>(_n, edge_index, weights);
+		_forest_slot = vector<int>(m);
+		for (int i = 0; i < m; ++i) _forest_slot[i] = i;
+		_tracking = true;
+	}
+	// bandwidth of the widest path from s to t through the tracked forest, O(log n)
+	_Weight bottleneck(const int s, const int t) {
+		assert(_tracking);
+		return _forest.bottleneck(_in(s), _in(t));
+	}
+	// the widest path itself, O(length + log n)
+	pair<vector<int>, _Weight> bottleneck_path(const int s, const int t) {
+		assert(_tracking);
+		pair<vector<int>, _Weight> ans(_forest.path(_in(s), _in(t)), _forest.bottleneck(_in(s), _in(t)));
+		return _out(ans);
+	}
+	// number of undirected edges
+	int num_edges() const { return _m / 2; }
 	// Dijkstra without heap
-	pair<vector<int>, int64_t> dijkstra_1(const int s, const int t) {
+	// with stop_at_target the search ends as soon as t is finalized
+	pair<vector<int>, _Weight> dijkstra_1(int s, int t, bool stop_at_target = false) {
+		commit();
+		STAT_TIMER(timer);
+		s = _in(s);
+		t = _in(t);
 		vector<int> status(_n, -1), dad(_n, -1);
-		vector<int64_t> b_width(_n, 0);
-		status[s] = 0;
-		b_width[s] = INT32_MAX;
+		vector<_Weight> b_width(_n, 0);
+		vector<int64_t> fringe(_n, -1);
+		b_width[s] = max_width;
 		dad[s] = s;
 		int fringer_count = 0;
 		auto add_fringer = [&](int v) {
 			status[v] = 1;
+			fringe[v] = _fringe_key(b_width[v]);
 			++fringer_count;
 		};
 		auto remove_fringer = [&](int v) {
 			status[v] = 0;
+			fringe[v] = -1;
 			--fringer_count;
 		};
-		for (auto edge : G[s]) {
-			add_fringer(edge.first);
-			b_width[edge.first] = edge.second;
-			dad[edge.first] = s;
-		}
-		while (fringer_count > 0) {
-			int v = _get_max_fringer(status, b_width);
+		// s is taken first and relaxes its edges like any other vertex, so parallel edges
+		// out of s are handled too
+		STAT_LAP(timer, setup);
+		add_fringer(s);
+		while (fringer_count > 0 && !(stop_at_target && status[t] == 0)) {
+			int v = _get_max_fringer(fringe);
 			remove_fringer(v);
-			for (auto edge : G[v]) {
+			STAT_INC(settled);
+			STAT_ADD(relaxations, _adj[v].size());
+			for (auto edge : _adj[v]) {
 				if (status[edge.first] == -1) {
 					dad[edge.first] = v;
 					b_width[edge.first] = min(b_width[v], edge.second);
@@ -199,94 +534,797 @@ class graph {
 						   b_width[edge.first] < min(b_width[v], edge.second)) {
 					dad[edge.first] = v;
 					b_width[edge.first] = min(b_width[v], edge.second);
+					fringe[edge.first] = _fringe_key(b_width[edge.first]);
 				}
 			}
 		}
-		pair<vector<int>, int64_t> ans(_retrace_path(dad, s, t), b_width[t]);
+		STAT_LAP(timer, search);
+		pair<vector<int>, _Weight> ans(_out(pair<vector<int>, _Weight>(_retrace_path(dad, s, t), b_width[t])));
+		STAT_LAP(timer, output);
 		return ans;
 	}
+	// The heap based algorithms take the priority queue as a template parameter:
+	// heap (binary), dary_heap, pairing_heap or radix_heap
 	// Dijikstra with heap
-	pair<vector<int>, int64_t> dijkstra_2(const int s, const int t) {
-		vector<int> status(_n, -1), dad(_n, -1);
-		vector<int64_t> b_width(_n, 0);
-		status[s] = 0;
-		b_width[s] = INT32_MAX;
-		dad[s] = s;
-		heap<int64_t> H(_n);
-		auto add_fringer = [&](int v) {
-			status[v] = 1;
-			H.insert(v, b_width[v]);
-		};
-		auto remove_fringer = [&](int v) {
-			status[v] = 0;
-			H.erase(v);
-		};
-		for (auto& edge : G[s]) {
-			b_width[edge.first] = edge.second;
-			dad[edge.first] = s;
-			add_fringer(edge.first);
+	template <typename _Heap = heap<_Weight>>
+	pair<vector<int>, _Weight> dijkstra_2(const int s, const int t, bool stop_at_target = false);
+	// Dijkstra with heap, keeping the widest path to every vertex
+	// if t is given, only vertices at least as wide as t are guaranteed to be finalized
+	template <typename _Heap = heap<_Weight>>
+	widest_tree widest_from(const int s, const int t = -1);
+	// target directed Dijkstra with heap reusing the scratch arrays of ws
+	// does not modify the graph, so threads with separate workspaces may call it at once
+	template <typename _Heap>
+	pair<vector<int>, _Weight> widest(const int s, const int t, query_workspace<_Heap>& ws) const {
+		ws.reset();
+		_widest(_in(s), _in(t), ws);
+		pair<vector<int>, _Weight> ans(ws.path(_in(t)), ws.b_width(_in(t)));
+		return _out(ans);
+	}
+	// Dijkstra growing from both s and t, stops once the frontiers prove a bottleneck
+	template <typename _Heap = heap<_Weight>>
+	pair<vector<int>, _Weight> widest_bidirectional(int s, int t);
+	// answer many (s, t) queries, solving each distinct source only once
+	template <typename _Heap = heap<_Weight>>
+	vector<pair<vector<int>, _Weight>> widest_batch(vector<pair<int, int>> const& queries);
+	// Kruskal Algorithm, over the edges radix sorted once per change of the graph
+	// _Heap is kept for the callers that pick the heap of every query, the edge order no
+	// longer uses one
+	template <typename _Heap = heap<_Weight>>
+	pair<vector<int>, _Weight> kruskal(const int s, const int t);
+	// Alternative routes, each returned with its own bandwidth and widest first
+	// the k widest simple paths from s to t (Yen's algorithm in bottleneck order), fewer if
+	// there are fewer
+	template <typename _Heap = heap<_Weight>>
+	vector<pair<vector<int>, _Weight>> widest_k(int s, int t, const int k);
+	// k edge disjoint paths from s to t whose narrowest is as wide as possible, or as many
+	// as there are if fewer
+	vector<pair<vector<int>, _Weight>> widest_disjoint(int s, int t, const int k);
+	// Aggregate bandwidth of all paths from s to t together, with the edge weights as
+	// capacities, and a minimum cut: the narrowest set of edges separating t from s
+	// The widest path (dijkstra_2) is pushed first, then Dinic's algorithm completes the flow.
+	template <typename _Heap = heap<_Weight>>
+	flow_result<flow_type> max_flow(int s, int t);
+	// build the maximum spanning tree once and index it for repeated queries
+	template <typename _Heap = heap<_Weight>>
+	basic_bottleneck_oracle<_Weight> oracle() {
+		return basic_bottleneck_oracle<_Weight>(_out(_max_spanning_tree()));
+	}
+	// Kruskal's and the oracle with the spanning tree built on multiple threads
+	// threads = 0 uses every hardware thread
+	pair<vector<int>, _Weight> kruskal_parallel(const int s, const int t, int threads = 0) {
+		return _out(_bfs(_max_spanning_tree_parallel(threads), _in(s), _in(t)));
+	}
+	basic_bottleneck_oracle<_Weight> oracle_parallel(int threads = 0) {
+		return basic_bottleneck_oracle<_Weight>(_out(_max_spanning_tree_parallel(threads)));
+	}
+};
+
+// all widest paths from a single source, as computed by dijkstra_2
+template <typename _Weight>
+class basic_graph<_Weight>::widest_tree {
+   public:
+	int source;
+	vector<int> dad;
+	vector<_Weight> b_width;
+	widest_tree(int n, int s) : source(s), dad(n, -1), b_width(n, 0) {}
+	pair<vector<int>, _Weight> path(const int t) const {
+		pair<vector<int>, _Weight> ans(_retrace_path(dad, source, t), b_width[t]);
+		return ans;
+	}
+};
+
+template <typename _Weight>
+template <typename _Heap>
+void basic_graph<_Weight>::_widest(const int s, const int t, query_workspace<_Heap>& ws) const {
+	assert(!_changed);
+	_Heap& H = ws.H;
+	ws.b_width(s) = max_width;
+	ws.dad(s) = s;
+	auto add_fringer = [&](int v) {
+		ws.status(v) = 1;
+		H.insert(v, ws.b_width(v));
+		STAT_INC(heap_inserts);
+	};
+	auto remove_fringer = [&]() {
+		int v = H.extract_max().first;
+		ws.status(v) = 0;
+		STAT_INC(heap_extractions);
+		return v;
+	};
+	// s is taken first and relaxes its edges like any other vertex
+	add_fringer(s);
+	while (H.size() > 0 && !(t != -1 && ws.status(t) == 0)) {
+		int v = remove_fringer();
+		_Weight bw_v = ws.b_width(v);
+		STAT_INC(settled);
+		STAT_ADD(relaxations, _adj[v].size());
+		for (auto edge : _adj[v]) {
+			int& status = ws.status(edge.first);
+			_Weight& b_width = ws.b_width(edge.first);
+			if (status == -1) {
+				ws.dad(edge.first) = v;
+				b_width = min(bw_v, edge.second);
+				add_fringer(edge.first);
+			} else if (status == 1 && b_width < min(bw_v, edge.second)) {
+				ws.dad(edge.first) = v;
+				b_width = min(bw_v, edge.second);
+				H.increase_key(edge.first, b_width);
+				STAT_INC(heap_increase_keys);
+			}
+		}
+	}
+}
+
+template <typename _Weight>
+template <typename _Heap>
+typename basic_graph<_Weight>::widest_tree basic_graph<_Weight>::_widest_from(const int s, const int t) {
+	commit();
+	STAT_TIMER(timer);
+	query_workspace<_Heap> ws(_n);
+	STAT_LAP(timer, setup);
+	_widest(s, t, ws);
+	STAT_LAP(timer, search);
+	widest_tree tree(_n, s);
+	for (int v = 0; v < _n; ++v) {
+		tree.dad[v] = ws.dad(v);
+		tree.b_width[v] = ws.b_width(v);
+	}
+	STAT_LAP(timer, output);
+	return tree;
+}
+
+template <typename _Weight>
+template <typename _Heap>
+typename basic_graph<_Weight>::widest_tree basic_graph<_Weight>::widest_from(const int s, const int t) {
+	widest_tree tree = _widest_from<_Heap>(_in(s), _in(t));
+	if (_label.size() == 0) return tree;
+	widest_tree ans(_n, s);
+	for (int v = 0; v < _n; ++v) {
+		ans.dad[_label[v]] = _out(tree.dad[v]);
+		ans.b_width[_label[v]] = tree.b_width[v];
+	}
+	return ans;
+}
+
+template <typename _Weight>
+template <typename _Heap>
+pair<vector<int>, _Weight> basic_graph<_Weight>::dijkstra_2(const int s, const int t, bool stop_at_target) {
+	return widest_from<_Heap>(s, stop_at_target ? t : -1).path(t);
+}
+
+template <typename _Weight>
+template <typename _Heap>
+pair<vector<int>, _Weight> basic_graph<_Weight>::widest_bidirectional(int s, int t) {
+	if (s == t) {
+		pair<vector<int>, _Weight> ans(vector<int>(1, s), max_width);
+		return ans;
+	}
+	commit();
+	s = _in(s);
+	t = _in(t);
+	STAT_TIMER(timer);
+	// search 0 grows from s, search 1 from t
+	struct search {
+		vector<int> status, dad;
+		vector<_Weight> b_width;
+		_Heap H;
+		search(int n, int root) : status(n, -1), dad(n, -1), b_width(n, 0), H(n) {
+			status[root] = 1;
+			dad[root] = root;
+			b_width[root] = max_width;
+			H.insert(root, max_width);
+		}
+	} side[2] = {search(_n, s), search(_n, t)};
+	STAT_ADD(heap_inserts, 2);
+	STAT_LAP(timer, setup);
+	// best bottleneck found so far, through the edge meet[0] - meet[1]
+	_Weight best = 0;
+	int meet[2] = {-1, -1};
+	// once either frontier is no wider than best, no unexplored path can beat it
+	while (side[0].H.size() > 0 && side[1].H.size() > 0) {
+		int d = side[0].H.peek().second >= side[1].H.peek().second ? 0 : 1;
+		search &cur = side[d], &other = side[d ^ 1];
+		if (min(side[0].H.peek().second, side[1].H.peek().second) <= best) break;
+		int v = cur.H.extract_max().first;
+		cur.status[v] = 0;
+		STAT_INC(heap_extractions);
+		STAT_INC(settled);
+		STAT_ADD(relaxations, _adj[v].size());
+		for (auto edge : _adj[v]) {
+			_Weight bw = min(cur.b_width[v], edge.second);
+			if (other.status[edge.first] != -1 && min(bw, other.b_width[edge.first]) > best) {
+				best = min(bw, other.b_width[edge.first]);
+				meet[d] = v;
+				meet[d ^ 1] = edge.first;
+			}
+			if (cur.status[edge.first] == -1) {
+				cur.status[edge.first] = 1;
+				cur.dad[edge.first] = v;
+				cur.b_width[edge.first] = bw;
+				cur.H.insert(edge.first, bw);
+				STAT_INC(heap_inserts);
+			} else if (cur.status[edge.first] == 1 && cur.b_width[edge.first] < bw) {
+				cur.dad[edge.first] = v;
+				cur.b_width[edge.first] = bw;
+				cur.H.increase_key(edge.first, bw);
+				STAT_INC(heap_increase_keys);
+			}
 		}
+	}
+	STAT_LAP(timer, search);
+	if (meet[0] == -1) {
+		// s and t are not connected
+		pair<vector<int>, _Weight> ans(vector<int>(), 0);
+		return ans;
+	}
+	vector<int> path = _retrace_path(side[0].dad, s, meet[0]);
+	for (int c = meet[1]; c != t; c = side[1].dad[c]) path.push_back(c);
+	path.push_back(t);
+	pair<vector<int>, _Weight> ans(_out(pair<vector<int>, _Weight>(path, best)));
+	STAT_LAP(timer, output);
+	return ans;
+}
+
+template <typename _Weight>
+template <typename _Heap>
+vector<pair<vector<int>, _Weight>> basic_graph<_Weight>::widest_batch(vector<pair<int, int>> const& queries) {
+	int q = queries.size();
+	// counting sort of the queries by source
+	vector<int> start(_n + 1, 0), order(q);
+	for (int i = 0; i < q; ++i) ++start[queries[i].first + 1];
+	for (int v = 0; v < _n; ++v) start[v + 1] += start[v];
+	vector<int> fill(_n);
+	for (int v = 0; v < _n; ++v) fill[v] = start[v];
+	for (int i = 0; i < q; ++i) order[fill[queries[i].first]++] = i;
+
+	vector<pair<vector<int>, _Weight>> ans(q);
+	for (int v = 0; v < _n; ++v) {
+		if (start[v] == start[v + 1]) continue;
+		widest_tree tree = widest_from<_Heap>(v);
+		for (int i = start[v]; i < start[v + 1]; ++i)
+			ans[order[i]] = tree.path(queries[order[i]].second);
+	}
+	return ans;
+}
+
+// The edges are taken from the sorted order one after the other, and the search stops
+// once the tree has n - 1 edges, which on dense graphs leaves most of them unread.
+template <typename _Weight>
+csr<_Weight> basic_graph<_Weight>::_max_spanning_tree() {
+	commit();
+	STAT_TIMER(timer);
+	vector<int> const& order = _kruskal_order();
+	STAT_LAP(timer, sort);
+	vector<pair<int, int>> tree;
+	vector<_Weight> tree_weights;
+	tree.reserve(_n - 1);
+	tree_weights.reserve(_n - 1);
+	union_find _forest(_n);
+	STAT_LAP(timer, setup);
+	for (int i = 0; i < (int)order.size() && (int)tree.size() < _n - 1; ++i) {
+		int e = order[i];
+		pair<int, int> edge = edge_index[e];
+		if (_forest.unify(edge.first, edge.second)) {
+			tree.push_back(edge);
+			tree_weights.push_back(weights[e]);
+		}
+	}
+	STAT_LAP(timer, forest);
+	csr<_Weight> ans(_n, tree, tree_weights);
+	STAT_LAP(timer, output);
+	return ans;
+}
+
+template <typename _Weight>
+template <typename _Heap>
+pair<vector<int>, _Weight> basic_graph<_Weight>::kruskal(const int s, const int t) {
+	return _out(_bfs(_max_spanning_tree(), _in(s), _in(t)));
+}
+
+// Every further path leaves one of the paths found so far at a spur vertex: it follows the
+// found path up to the spur, then takes the widest path to t that avoids the vertices
+// before the spur and the edges out of the spur taken by found paths sharing that prefix.
+// The widest tree of t gives for every vertex the widest way on to t, ignoring the bans.
+// - spurs wait in the pool bounded by it and are only searched once nothing in the pool is
+//   wider (lazy Yen)
+// - the search is ordered by the narrower of the width so far and the bound of the vertex
+//   (A*), and ends at the first vertex whose tree path to t avoids the bans, which then
+//   completes the path
+// - it only looks for a path wider than the widest candidate waiting; if there is none the
+//   spur goes back to the pool bounded by that candidate
+// All spur searches reuse one workspace.
+template <typename _Weight>
+template <typename _Heap>
+vector<pair<vector<int>, _Weight>> basic_graph<_Weight>::widest_k(int s, int t, const int k) {
+	commit();
+	vector<pair<vector<int>, _Weight>> ans;
+	if (k <= 0) return ans;
+	if (s == t) {
+		ans.push_back(pair<vector<int>, _Weight>(vector<int>(1, s), max_width));
+		return ans;
+	}
+	s = _in(s);
+	t = _in(t);
+	// to_t.b_width[v] is the bandwidth of the widest path from v to t
+	widest_tree to_t = _widest_from<_Heap>(t);
+	if (to_t.dad[s] == -1) return ans;
+	// a found path or candidate, reach[i] is the bandwidth from s to path[i]
+	struct route {
+		vector<int> path;
+		vector<_Weight> reach;
+		void extend(int v, _Weight w) {
+			reach.push_back(min(reach[reach.size() - 1], w));
+			path.push_back(v);
+		}
+	};
+	// a candidate to pick, or a spur at path[spur] of found[parent] still to search
+	struct entry {
+		_Weight width;
+		int serial, parent, spur;
+		route r;
+	};
+	vector<route> found;
+	vector<entry> pool;
+	int serial = 0;
+	auto add_spurs = [&](int f) {
+		route const& p = found[f];
+		for (int j = 0; j + 1 < (int)p.path.size(); ++j) {
+			entry x;
+			x.width = min(p.reach[j], to_t.b_width[p.path[j]]);
+			x.serial = serial++;
+			x.parent = f;
+			x.spur = j;
+			pool.push_back(std::move(x));
+		}
+	};
+	// the widest path itself, down the tree of t
+	route first;
+	first.path.push_back(s);
+	first.reach.push_back(max_width);
+	for (int v = s; v != t; v = to_t.dad[v]) first.extend(to_t.dad[v], _edge_width(v, to_t.dad[v]));
+	found.push_back(std::move(first));
+	add_spurs(0);
+
+	query_workspace<_Heap> ws(_n);
+	_Heap& H = ws.H;
+	// banned[v] == stamp: v is before the spur, next_banned[v] == stamp: the spur may not
+	// step to v, clean[v] == 2 * stamp + 1 (2 * stamp): the tree path from v to t avoids
+	// (meets) the bans and the spur
+	vector<int> banned(_n, 0), next_banned(_n, 0), clean(_n, 0), at(_n, -1), climb;
+	int stamp = 0, spur = -1;
+	auto is_clean = [&](int v) {
+		climb.clear();
+		bool ok = true;
+		for (int x = v; x != t; x = to_t.dad[x]) {
+			if (clean[x] >> 1 == stamp) {
+				ok = clean[x] & 1;
+				break;
+			}
+			climb.push_back(x);
+			if (banned[to_t.dad[x]] == stamp || to_t.dad[x] == spur) {
+				ok = false;
+				break;
+			}
+		}
+		for (int x : climb) clean[x] = 2 * stamp + ok;
+		return ok;
+	};
+	vector<_Weight> widths;
+	while ((int)found.size() < k && pool.size() > 0) {
+		// widest first, then searched candidates before spurs, then oldest
+		int best = 0;
+		for (int i = 1; i < (int)pool.size(); ++i) {
+			entry const &a = pool[i], &b = pool[best];
+			if (a.width != b.width ? a.width > b.width
+				: (a.parent == -1) != (b.parent == -1) ? a.parent == -1 : a.serial < b.serial)
+				best = i;
+		}
+		entry x = std::move(pool[best]);
+		if (best != (int)pool.size() - 1) pool[best] = std::move(pool[pool.size() - 1]);
+		pool.pop_back();
+		if (x.parent == -1) {
+			found.push_back(std::move(x.r));
+			add_spurs(found.size() - 1);
+			continue;
+		}
+		// with need candidates at least floor wide, nothing narrower can be picked
+		int need = k - found.size();
+		_Weight floor = 0, bound = 0;
+		widths.clear();
+		for (auto& c : pool)
+			if (c.parent == -1) widths.push_back(c.width);
+		for (_Weight w : widths) bound = max(bound, w);
+		if ((int)widths.size() >= need) {
+			std::nth_element(&widths[0], &widths[0] + need - 1, &widths[0] + widths.size(),
+							 [](_Weight a, _Weight b) { return a > b; });
+			floor = widths[need - 1];
+		}
+		if (x.width <= floor) continue;
+		route const& p = found[x.parent];
+		int j = x.spur;
+		spur = p.path[j];
+		++stamp;
+		for (int i = 0; i < j; ++i) banned[p.path[i]] = stamp;
+		for (auto& f : found) {
+			if ((int)f.path.size() <= j + 1) continue;
+			bool shared = true;
+			for (int i = 0; i <= j && shared; ++i) shared = f.path[i] == p.path[i];
+			if (shared) next_banned[f.path[j + 1]] = stamp;
+		}
+		ws.reset();
+		ws.status(spur) = 1;
+		ws.dad(spur) = spur;
+		ws.b_width(spur) = max_width;
+		H.insert(spur, to_t.b_width[spur]);
+		int end = -1;
 		while (H.size() > 0) {
-			int v = H.peek().first;
-			remove_fringer(v);
-			for (auto& edge : G[v]) {
-				if (status[edge.first] == -1) {
-					dad[edge.first] = v;
-					b_width[edge.first] = min(b_width[v], edge.second);
-					add_fringer(edge.first);
-				} else if (status[edge.first] == 1 &&
-						   b_width[edge.first] < min(b_width[v], edge.second)) {
-					dad[edge.first] = v;
-					b_width[edge.first] = min(b_width[v], edge.second);
-					H.increase_key(edge.first, b_width[edge.first]);
+			auto top = H.extract_max();
+			int v = top.first;
+			if (top.second <= bound) break;
+			ws.status(v) = 0;
+			if ((v != spur || next_banned[to_t.dad[v]] != stamp) && is_clean(v)) {
+				end = v;
+				break;
+			}
+			_Weight bw_v = ws.b_width(v);
+			for (auto edge : _adj[v]) {
+				int u = edge.first;
+				if (edge.second <= bound || to_t.b_width[u] <= bound || banned[u] == stamp ||
+					(v == spur && next_banned[u] == stamp))
+					continue;
+				_Weight bw = min(bw_v, (_Weight)edge.second);
+				int& status = ws.status(u);
+				if (status == -1) {
+					status = 1;
+					ws.dad(u) = v;
+					ws.b_width(u) = bw;
+					H.insert(u, min(bw, to_t.b_width[u]));
+				} else if (status == 1 && ws.b_width(u) < bw) {
+					ws.dad(u) = v;
+					ws.b_width(u) = bw;
+					H.increase_key(u, min(bw, to_t.b_width[u]));
 				}
 			}
 		}
-		pair<vector<int>, int64_t> ans(_retrace_path(dad, s, t), b_width[t]);
-		return ans;
+		if (end == -1) {
+			// nothing wider than bound, try again once bound is the widest
+			if (bound > floor) {
+				x.width = bound;
+				pool.push_back(std::move(x));
+			}
+			continue;
+		}
+		// the search path to end, then the tree path to t, with any loop between them cut out
+		vector<int> rest, route_walk = ws.path(end);
+		for (int y = end; y != t;) route_walk.push_back(y = to_t.dad[y]);
+		for (int v : route_walk) {
+			if (at[v] == -1) {
+				at[v] = rest.size();
+				rest.push_back(v);
+				continue;
+			}
+			while (rest[rest.size() - 1] != v) {
+				at[rest[rest.size() - 1]] = -1;
+				rest.pop_back();
+			}
+		}
+		entry c;
+		for (int i = 0; i <= j; ++i) {
+			c.r.path.push_back(p.path[i]);
+			c.r.reach.push_back(p.reach[i]);
+		}
+		for (int i = 1; i < (int)rest.size(); ++i)
+			c.r.extend(rest[i], _edge_width(rest[i - 1], rest[i]));
+		for (int v : rest) at[v] = -1;
+		bool known = false;
+		for (auto& y : pool) known = known || (y.parent == -1 && y.r.path == c.r.path);
+		for (auto& f : found) known = known || f.path == c.r.path;
+		if (known) continue;
+		c.width = c.r.reach[c.r.reach.size() - 1];
+		c.serial = serial++;
+		c.parent = c.spur = -1;
+		pool.push_back(std::move(c));
 	}
-	// Kruskal Algorithm
-	pair<vector<int>, int64_t> kruskal(const int s, const int t);
-};
+	for (auto& f : found)
+		ans.push_back(_out(pair<vector<int>, _Weight>(f.path, f.reach[f.reach.size() - 1])));
+	return ans;
+}
 
-class graph::dsu {
-   private:
-	int _n;
-	vector<int> parent, rank;
+// Filter-Kruskal: split the edges around a pivot, solve the heavy half first, then drop
+// every light edge that already closes a cycle before solving the rest. Partitioning and
+// filtering are split into chunks processed in parallel and concatenated in chunk order,
+// so the result does not depend on the number of threads.
+template <typename _Weight>
+void basic_graph<_Weight>::_filter_kruskal(vector<int>& ids, vector<int>& buf, int lo, int hi,
+							concurrent_union_find& forest, vector<int>& chosen, int threads) {
+	const int base_case = 1 << 12;
+	while (hi - lo > 0 && (int)chosen.size() < _n - 1) {
+		if (hi - lo <= base_case) {
+			std::sort(&ids[lo], &ids[lo] + (hi - lo), [&](int a, int b) { return _heavier(a, b); });
+			for (int i = lo; i < hi && (int)chosen.size() < _n - 1; ++i) {
+				pair<int, int> edge = edge_index[ids[i]];
+				if (forest.unify(edge.first, edge.second)) chosen.push_back(ids[i]);
+			}
+			return;
+		}
+		// median of 9 evenly spaced samples, so both halves are non empty
+		int sample[9];
+		for (int i = 0; i < 9; ++i) sample[i] = ids[lo + (int64_t)(hi - lo - 1) * i / 8];
+		std::sort(sample, sample + 9, [&](int a, int b) { return _heavier(a, b); });
+		int pivot = sample[4];
 
-   public:
-	dsu(int n) : _n(n), parent(n), rank(n) {
-		for (int i = 0; i < _n; ++i) {
-			parent[i] = i;
-			rank[i] = 1;
+		// parallel partition into buf, heavy edges first
+		int count = hi - lo;
+		vector<int> heavy(threads + 1, 0), light(threads + 1, 0);
+		int chunks = _parallel_chunks(threads, count, [&](int c, int l, int h) {
+			int n_heavy = 0;
+			for (int i = lo + l; i < lo + h; ++i) n_heavy += _heavier(ids[i], pivot);
+			heavy[c + 1] = n_heavy;
+			light[c + 1] = h - l - n_heavy;
+		});
+		for (int c = 0; c < chunks; ++c) {
+			heavy[c + 1] += heavy[c];
+			light[c + 1] += light[c];
 		}
+		int mid = lo + heavy[chunks];
+		_parallel_chunks(threads, count, [&](int c, int l, int h) {
+			int hp = lo + heavy[c], lp = mid + light[c];
+			for (int i = lo + l; i < lo + h; ++i) buf[_heavier(ids[i], pivot) ? hp++ : lp++] = ids[i];
+		});
+		_parallel_chunks(threads, count, [&](int, int l, int h) {
+			for (int i = lo + l; i < lo + h; ++i) ids[i] = buf[i];
+		});
+		_filter_kruskal(ids, buf, lo, mid, forest, chosen, threads);
+
+		// parallel filter of the light edges, finds from all threads shorten the same paths
+		count = hi - mid;
+		vector<int> kept(threads + 1, 0);
+		auto useful = [&](int e) {
+			return !forest.connected(edge_index[e].first, edge_index[e].second);
+		};
+		chunks = _parallel_chunks(threads, count, [&](int c, int l, int h) {
+			int n_kept = 0;
+			for (int i = mid + l; i < mid + h; ++i) n_kept += useful(ids[i]);
+			kept[c + 1] = n_kept;
+		});
+		for (int c = 0; c < chunks; ++c) kept[c + 1] += kept[c];
+		_parallel_chunks(threads, count, [&](int c, int l, int h) {
+			int p = mid + kept[c];
+			for (int i = mid + l; i < mid + h; ++i)
+				if (useful(ids[i])) buf[p++] = ids[i];
+		});
+		_parallel_chunks(threads, kept[chunks], [&](int, int l, int h) {
+			for (int i = mid + l; i < mid + h; ++i) ids[i] = buf[i];
+		});
+		lo = mid;
+		hi = mid + kept[chunks];
 	}
-	int find(int x) {
-		if (parent[x] == x) return x;
-		else
-			return (parent[x] = find(parent[x]));
+}
+
+template <typename _Weight>
+csr<_Weight> basic_graph<_Weight>::_max_spanning_tree_parallel(int threads) {
+	commit();
+	if (threads <= 0) threads = max(1, (int)std::thread::hardware_concurrency());
+	int m = _m / 2;
+	vector<int> ids(m), buf(m), chosen;
+	for (int i = 0; i < m; ++i) ids[i] = i;
+	chosen.reserve(_n - 1);
+	concurrent_union_find forest(_n);
+	_filter_kruskal(ids, buf, 0, m, forest, chosen, threads);
+	vector<pair<int, int>> tree(chosen.size());
+	vector<_Weight> tree_weights(chosen.size());
+	for (int i = 0; i < (int)chosen.size(); ++i) {
+		tree[i] = edge_index[chosen[i]];
+		tree_weights[i] = weights[chosen[i]];
 	}
-	void unify(int a, int b) {
-		if (rank[a] >= rank[b]) parent[b] = a;
-		else if (rank[b] > rank[a])
-			parent[a] = b;
-		if (rank[a] == rank[b]) ++rank[a];
+	return csr<_Weight>(_n, tree, tree_weights);
+}
+
+// Edges are added in Kruskal's order, heaviest first, to a unit capacity flow from s to t.
+// Until s and t are connected this is Kruskal's itself. The order, shared with kruskal,
+// and the edges of every vertex in the same order are kept for later queries until the
+// graph changes. From then on the vertices reachable from s in the residual graph are
+// kept, and an added edge only extends them from its new end, so every augmentation
+// costs one O(n + m) search and every other edge O(1) plus the vertices it makes
+// reachable. The flow reaches k paths at the narrowest possible edge, which is the
+// answer, and is then split into paths.
+template <typename _Weight>
+vector<pair<vector<int>, _Weight>> basic_graph<_Weight>::widest_disjoint(int s, int t, const int k) {
+	commit();
+	vector<pair<vector<int>, _Weight>> ans;
+	if (k <= 0) return ans;
+	if (s == t) {
+		ans.push_back(pair<vector<int>, _Weight>(vector<int>(1, s), max_width));
+		return ans;
 	}
-};
+	s = _in(s);
+	t = _in(t);
+	int m = _m / 2;
+	auto other = [&](int e, int x) {
+		return edge_index[e].first == x ? edge_index[e].second : edge_index[e].first;
+	};
+	vector<int> const& order = _kruskal_order();
+	if (!_has_incident) {
+		vector<int> offset(_n + 1, 0), target(2 * m), ids(2 * m);
+		for (int e = 0; e < m; ++e) {
+			++offset[edge_index[e].first + 1];
+			++offset[edge_index[e].second + 1];
+		}
+		for (int v = 0; v < _n; ++v) offset[v + 1] += offset[v];
+		vector<int> fill(_n);
+		for (int v = 0; v < _n; ++v) fill[v] = offset[v];
+		// filled in Kruskal's order, every vertex gets its edges heaviest first
+		for (int e : order) {
+			ids[fill[edge_index[e].first]++] = e;
+			ids[fill[edge_index[e].second]++] = e;
+		}
+		for (int v = 0; v < _n; ++v)
+			for (int i = offset[v]; i < offset[v + 1]; ++i) target[i] = other(ids[i], v);
+		_incident = csr<int>(_n, std::move(offset), std::move(target), std::move(ids));
+		_has_incident = true;
+	}
+	csr<int> const& incident = _incident;
+	// flow[e] is 1 from edge_index[e].first to .second, -1 the other way, 0 unused
+	vector<char> active(m, 0), flow(m, 0);
+	// edge through which v was reached from s, m for s and -1 if v is not reachable
+	vector<int> via(_n, -1);
+	// e has room from x towards its other end
+	auto residual = [&](int e, int x) { return flow[e] != (edge_index[e].first == x ? 1 : -1); };
+	// weight of the last edge added, every lighter edge is inactive
+	_Weight lightest = max_width;
+	ring_queue<int> q(_n);
+	auto grow = [&](int x) {
+		q.push(x);
+		while (q.size() > 0) {
+			int u = q.pop();
+			for (int i = incident.begin(u); i < incident.end(u); ++i) {
+				int e = incident.weight(i), y = incident.target(i);
+				if (weights[e] < lightest) break;
+				if (active[e] && via[y] == -1 && residual(e, u)) {
+					via[y] = e;
+					q.push(y);
+				}
+			}
+		}
+	};
+	auto restart = [&]() {
+		for (int v = 0; v < _n; ++v) via[v] = -1;
+		via[s] = m;
+		grow(s);
+	};
+	union_find forest(_n);
+	bool connected = false;
+	int paths = 0;
+	for (int i = 0; i < m && paths < k; ++i) {
+		int e = order[i], u = edge_index[e].first, v = edge_index[e].second;
+		active[e] = 1;
+		lightest = weights[e];
+		if (!connected) {
+			forest.unify(u, v);
+			if (!forest.connected(s, t)) continue;
+			connected = true;
+			restart();
+		} else if (via[u] != -1 && via[v] == -1) {
+			via[v] = e;
+			grow(v);
+		} else if (via[v] != -1 && via[u] == -1) {
+			via[u] = e;
+			grow(u);
+		}
+		while (via[t] != -1 && paths < k) {
+			for (int x = t; x != s;) {
+				int f = via[x], y = other(f, x);
+				flow[f] += edge_index[f].first == y ? 1 : -1;
+				x = y;
+			}
+			++paths;
+			restart();
+		}
+	}
+
+	// follow the flow out of s until t, cutting out any cycle on the way
+	vector<int> cursor(_n), at(_n, -1);
+	for (int v = 0; v < _n; ++v) cursor[v] = incident.begin(v);
+	vector<char> used(m, 0);
+	for (int p = 0; p < paths; ++p) {
+		vector<int> path(1, s), edges;
+		at[s] = 0;
+		for (int u = s; u != t;) {
+			int e = incident.weight(cursor[u]);
+			// the next unused edge carrying flow out of u
+			while (used[e] || residual(e, u)) e = incident.weight(++cursor[u]);
+			used[e] = 1;
+			u = other(e, u);
+			if (at[u] != -1) {
+				while ((int)path.size() > at[u] + 1) {
+					at[path[path.size() - 1]] = -1;
+					path.pop_back();
+					edges.pop_back();
+				}
+			} else {
+				at[u] = path.size();
+				path.push_back(u);
+				edges.push_back(e);
+			}
+		}
+		_Weight bw = max_width;
+		for (int e : edges) bw = min(bw, weights[e]);
+		for (int v : path) at[v] = -1;
+		ans.push_back(_out(pair<vector<int>, _Weight>(std::move(path), bw)));
+	}
+	if (paths > 1)
+		std::sort(&ans[0], &ans[0] + ans.size(),
+				  [](pair<vector<int>, _Weight> const& a, pair<vector<int>, _Weight> const& b) {
+					  return a.second > b.second;
+				  });
+	return ans;
+}
+
+template <typename _Weight>
+template <typename _Heap>
+flow_result<typename basic_graph<_Weight>::flow_type> basic_graph<_Weight>::max_flow(int s, int t) {
+	commit();
+	assert(s != t);
+	s = _in(s);
+	t = _in(t);
+	flow_network<flow_type> network(_n, edge_index, weights);
+	// the widest path carries the most any single path can, often most of the flow
+	query_workspace<_Heap> ws(_n);
+	_widest(s, t, ws);
+	network.push_path(ws.path(t));
+	flow_type value = network.max_flow(s, t);
+	flow_result<flow_type> ans = network.min_cut(s);
+	// floating point capacities may round differently on both sides
+	assert(std::is_floating_point<flow_type>::value || ans.value == value);
+	for (int& v : ans.source_side) v = _out(v);
+	for (auto& e : ans.cut) e = pair<int, int>(_out(e.first), _out(e.second));
+	return ans;
+}
+
+// Vertex v goes to the position of v in the order. Edge ids are kept, every edge is stored
+// with its endpoints renamed and the adjacency is rebuilt from the edge list. The labels
+// of a graph reordered before are composed with the new order.
+template <typename _Weight>
+void basic_graph<_Weight>::reorder(vertex_order how) {
+	commit();
+	if (how == vertex_order::none) return;
+	vector<int> order = make_vertex_order(_adj, how);
+	vector<int> rank(_n), label(_n), caller_rank(_n);
+	for (int i = 0; i < _n; ++i) rank[order[i]] = i;
+	for (int i = 0; i < _n; ++i) {
+		label[i] = _out(order[i]);
+		caller_rank[label[i]] = i;
+	}
+	int m = _m / 2;
+	vector<pair<int, int>> edges(m);
+	vector<_Weight> edge_weights(m);
+	for (int e = 0; e < m; ++e) {
+		int u = rank[edge_index[e].first], v = rank[edge_index[e].second];
+		edges[e] = pair<int, int>(min(u, v), max(u, v));
+		edge_weights[e] = weights[e];
+	}
+	_adj = csr<_Weight>(_n, edges, edge_weights);
+	edge_index = std::move(edges);
+	weights = std::move(edge_weights);
+	_label = std::move(label);
+	_rank = std::move(caller_rank);
+	// everything kept by vertex or by endpoints is rebuilt on demand
+	_edge_ids.clear();
+	_indexed = false;
+	_incident = csr<int>();
+	_has_incident = false;
+	if (_tracking) {
+		_tracking = false;
+		track_spanning_forest();
+	}
+}
 
-pair<vector<int>, int64_t> graph::kruskal(const int s, const int t) {
-	heap<int64_t> H(weights);
-	vector<vector<pair<int, int64_t>>> tree(_n);
-	dsu _forest(_n);
-	while (H.size() > 0) {
-		auto w = H.extract_max();
-		pair<int, int> edge = edge_index[w.first];
-		int a = _forest.find(edge.first), b = _forest.find(edge.second);
-		if (a != b) {
-			_forest.unify(a, b);
-			tree[edge.first].push_back({edge.second, w.second});
-			tree[edge.second].push_back({edge.first, w.second});
-		}
-	}
-	return _bfs(tree, s, t);
-}
\ No newline at end of file
+// weights are drawn from [1, INT32_MAX], define GRAPH_COMPACT_WEIGHTS to keep them in 32 bits
+// and halve the memory the searches stream through
+#ifdef GRAPH_COMPACT_WEIGHTS
+using graph = basic_graph<int32_t>;
+#else
+using graph = basic_graph<int64_t>;
+#endif
+using bottleneck_oracle = basic_bottleneck_oracle<graph::weight_type>;
@@ -0,0 +1,437 @@
+#pragma once
+// for offsetof
+#include <cstddef>
+// for fopen, getline and friends
+#include <cstdio>
+// for strtoll
+#include <cstdlib>
+// for memcpy and memcmp
+#include <cstring>
+// for std::numeric_limits
+#include <limits>
+// for std::shared_ptr
+#include <memory>
+// for std::is_same
+#include <type_traits>
+// for open, mmap and friends
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "csr.hh"
+#include "graph.hh"
+#include "shared_array.hh"
+#include "util.hh"
+#include "vector.hh"
+
+// Binary graph file
+// A header followed by the arrays of the graph exactly as they are kept in memory: the CSR
+// offsets, neighbours and weights, then the edge list and its weights. Every section
+// starts at a multiple of 8 bytes, so load_graph maps the file and hands the sections to
+// the graph without parsing or copying anything; pages are read lazily by the queries
+// that touch them. Numbers are in the byte order of the machine that wrote the file.
+// CSR weights are 4 or 8 byte integers, edge list weights always 8 byte integers; a graph
+// with other weights gets a converted copy of the sections that differ. A reordered graph
+// (basic_graph::reorder) keeps its vertex labels and ranks in two more sections, so it is
+// loaded with the same ids; version 1 files have neither and are still read.
+//
+// import_graph converts text edge lists and DIMACS files into this format in two
+// streaming passes, keeping only O(n) memory besides the output mapping.
+
+const uint32_t graph_file_version = 2;
+
+struct graph_file_header {
+	char magic[8];
+	uint32_t version;
+	// 0x01020304 as written by the machine that wrote the file
+	uint32_t byte_order;
+	// bytes of a CSR weight, sizeof the weight type of the graph that was saved
+	uint32_t weight_bytes;
+	uint32_t reserved;
+	// vertices and undirected edges
+	uint64_t n, m;
+	// byte positions of the sections
+	uint64_t offsets, targets, adjacency_weights, edges, edge_weights;
+	// total size of the file
+	uint64_t size;
+	// since version 2: byte positions of the vertex labels and ranks, 0 if there are none
+	uint64_t labels, ranks;
+};
+static_assert(sizeof(graph_file_header) == 104, "graph_file_header must not be padded");
+// version 1 headers end before the labels
+const size_t graph_file_header_v1_bytes = offsetof(graph_file_header, labels);
+static_assert(sizeof(pair<int, int>) == 8, "edges are mapped as two ints");
+
+// header of a file holding n vertices and m edges, with vertex labels if labeled
+inline graph_file_header graph_file_layout(uint64_t n, uint64_t m,
+										   uint32_t weight_bytes = sizeof(graph::weight_type),
+										   bool labeled = false) {
+	auto align = [](uint64_t x) { return (x + 7) / 8 * 8; };
+	graph_file_header h;
+	std::memset(&h, 0, sizeof(h));
+	std::memcpy(h.magic, "MBPGRAPH", 8);
+	h.version = graph_file_version;
+	h.byte_order = 0x01020304;
+	h.weight_bytes = weight_bytes;
+	h.n = n;
+	h.m = m;
+	h.offsets = align(sizeof(graph_file_header));
+	h.targets = align(h.offsets + (n + 1) * sizeof(int));
+	h.adjacency_weights = align(h.targets + 2 * m * sizeof(int));
+	h.edges = align(h.adjacency_weights + 2 * m * weight_bytes);
+	h.edge_weights = align(h.edges + m * sizeof(pair<int, int>));
+	h.size = h.edge_weights + m * sizeof(int64_t);
+	if (labeled) {
+		h.labels = align(h.size);
+		h.ranks = align(h.labels + n * sizeof(int));
+		h.size = h.ranks + n * sizeof(int);
+	}
+	return h;
+}
+
+// Memory mapping of a whole file, unmapped when destroyed
+// Read only by default; writable creates (or truncates) the file with the given size.
+class mapped_file {
+   private:
+	char* _data = nullptr;
+	size_t _size = 0;
+
+   public:
+	mapped_file(const char* path, bool writable = false, size_t size = 0) {
+		int fd = writable ? open(path, O_RDWR | O_CREAT | O_TRUNC, 0644) : open(path, O_RDONLY);
+		if (fd < 0) throw generic_exception("cannot open graph file");
+		struct stat st;
+		if (writable ? ftruncate(fd, size) != 0 : fstat(fd, &st) != 0) {
+			close(fd);
+			throw generic_exception("cannot size graph file");
+		}
+		_size = writable ? size : st.st_size;
+		if (_size > 0) {
+			void* p = mmap(nullptr, _size, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+						   writable ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+			if (p == MAP_FAILED) {
+				close(fd);
+				throw generic_exception("cannot map graph file");
+			}
+			_data = (char*)p;
+		}
+		close(fd);
+	}
+	mapped_file(mapped_file const&) = delete;
+	mapped_file& operator=(mapped_file const&) = delete;
+	~mapped_file() {
+		if (_data != nullptr) munmap(_data, _size);
+	}
+	char* data() const { return _data; }
+	size_t size() const { return _size; }
+};
+
+// write G to path
+template <typename _Weight>
+void save_graph(basic_graph<_Weight> const& G, const char* path) {
+	static_assert(std::is_integral<_Weight>::value && (sizeof(_Weight) == 4 || sizeof(_Weight) == 8),
+				  "graph files hold 4 or 8 byte integer weights");
+	csr<_Weight> const& adj = G.adjacency();
+	graph_file_header h =
+		graph_file_layout(G.num_vertices(), G.num_edges(), sizeof(_Weight), G.reordered());
+	mapped_file file(path, true, h.size);
+	auto put = [&](uint64_t pos, void const* src, size_t bytes) {
+		if (bytes > 0) std::memcpy(file.data() + pos, src, bytes);
+	};
+	put(0, &h, sizeof(h));
+	put(h.offsets, adj.offsets().data(), (h.n + 1) * sizeof(int));
+	put(h.targets, adj.targets().data(), 2 * h.m * sizeof(int));
+	put(h.adjacency_weights, adj.weights().data(), 2 * h.m * sizeof(_Weight));
+	put(h.edges, G.edge_list().data(), h.m * sizeof(pair<int, int>));
+	int64_t* edge_weights = (int64_t*)(file.data() + h.edge_weights);
+	for (uint64_t e = 0; e < h.m; ++e) edge_weights[e] = G.edge_weights()[e];
+	if (G.reordered()) {
+		put(h.labels, G.vertex_labels().data(), h.n * sizeof(int));
+		put(h.ranks, G.vertex_ranks().data(), h.n * sizeof(int));
+	}
+}
+
+// weights of a file section as _Weight, mapped if they are stored that way and copied
+// otherwise; stored is 4 or 8 bytes wide
+template <typename _Weight>
+shared_array<_Weight> _file_weights(std::shared_ptr<mapped_file> const& file, uint64_t pos,
+									uint64_t count, uint32_t stored) {
+	char const* data = file->data() + pos;
+	if (std::is_integral<_Weight>::value && sizeof(_Weight) == stored)
+		return shared_array<_Weight>((_Weight const*)data, count, file);
+	vector<_Weight> converted(count);
+	for (uint64_t e = 0; e < count; ++e) {
+		int64_t w = stored == 4 ? ((int32_t const*)data)[e] : ((int64_t const*)data)[e];
+		if (w < 1 || (long double)w > (long double)std::numeric_limits<_Weight>::max())
+			throw generic_exception("graph file weight out of range");
+		converted[e] = w;
+	}
+	return shared_array<_Weight>(std::move(converted));
+}
+
+// header of a mapped graph file, checked against the file size
+inline graph_file_header _graph_file_header(mapped_file const& file) {
+	graph_file_header h;
+	std::memset(&h, 0, sizeof(h));
+	if (file.size() < graph_file_header_v1_bytes) throw generic_exception("not a graph file");
+	std::memcpy(&h, file.data(), graph_file_header_v1_bytes);
+	if (std::memcmp(h.magic, "MBPGRAPH", 8) != 0) throw generic_exception("not a graph file");
+	if (h.version < 1 || h.version > graph_file_version)
+		throw generic_exception("unsupported graph file version");
+	if (h.version >= 2) {
+		if (file.size() < sizeof(h)) throw generic_exception("not a graph file");
+		std::memcpy(&h, file.data(), sizeof(h));
+	}
+	if (h.byte_order != 0x01020304) throw generic_exception("graph file has foreign byte order");
+	if (h.weight_bytes != 4 && h.weight_bytes != 8)
+		throw generic_exception("unsupported graph file weight size");
+	if (h.n >= INT32_MAX || 2 * h.m > INT32_MAX || h.size != file.size())
+		throw generic_exception("corrupt graph file header");
+	auto fits = [&](uint64_t pos, uint64_t bytes) { return pos % 8 == 0 && pos + bytes <= h.size; };
+	if (!fits(h.offsets, (h.n + 1) * sizeof(int)) || !fits(h.targets, 2 * h.m * sizeof(int)) ||
+		!fits(h.adjacency_weights, 2 * h.m * h.weight_bytes) ||
+		!fits(h.edges, h.m * sizeof(pair<int, int>)) ||
+		!fits(h.edge_weights, h.m * sizeof(int64_t)) || (h.labels == 0) != (h.ranks == 0) ||
+		(h.labels != 0 && (!fits(h.labels, h.n * sizeof(int)) || !fits(h.ranks, h.n * sizeof(int)))))
+		throw generic_exception("corrupt graph file header");
+	return h;
+}
+
+// map the graph written to path by save_graph or import_graph
+// Only the header is checked, the arrays are trusted to be consistent.
+template <typename _Weight = graph::weight_type>
+basic_graph<_Weight> load_graph(const char* path) {
+	auto file = std::make_shared<mapped_file>(path);
+	graph_file_header h = _graph_file_header(*file);
+
+	char const* base = file->data();
+	shared_array<int> offsets((int const*)(base + h.offsets), h.n + 1, file);
+	shared_array<int> targets((int const*)(base + h.targets), 2 * h.m, file);
+	shared_array<_Weight> adjacency_weights =
+		_file_weights<_Weight>(file, h.adjacency_weights, 2 * h.m, h.weight_bytes);
+	shared_array<pair<int, int>> edges((pair<int, int> const*)(base + h.edges), h.m, file);
+	shared_array<_Weight> edge_weights = _file_weights<_Weight>(file, h.edge_weights, h.m, 8);
+	shared_array<int> labels, ranks;
+	if (h.labels != 0) {
+		labels = shared_array<int>((int const*)(base + h.labels), h.n, file);
+		ranks = shared_array<int>((int const*)(base + h.ranks), h.n, file);
+	}
+	return basic_graph<_Weight>(
+		csr<_Weight>(h.n, std::move(offsets), std::move(targets), std::move(adjacency_weights)),
+		std::move(edges), std::move(edge_weights), std::move(labels), std::move(ranks));
+}
+
+// Oracle file
+// The arrays of a basic_bottleneck_oracle after a header, laid out like a graph file, so
+// load_oracle maps them and a service answers its first query without rebuilding the
+// tree. The weights are stored as the oracle holds them and must be loaded as the same
+// type.
+const uint32_t oracle_file_version = 1;
+
+struct oracle_file_header {
+	char magic[8];
+	uint32_t version;
+	// 0x01020304 as written by the machine that wrote the file
+	uint32_t byte_order;
+	// bytes and kind of a weight: 0 signed integer, 1 unsigned integer, 2 floating point
+	uint32_t weight_bytes, weight_kind;
+	uint64_t n;
+	// byte positions of the sections and total size of the file
+	uint64_t depths, roots, ancestors, narrowest, size;
+};
+static_assert(sizeof(oracle_file_header) == 72, "oracle_file_header must not be padded");
+
+template <typename _Weight>
+constexpr uint32_t _weight_kind() {
+	return std::is_floating_point<_Weight>::value ? 2 : std::is_signed<_Weight>::value ? 0 : 1;
+}
+
+// header of an oracle file over n vertices
+template <typename _Weight>
+oracle_file_header oracle_file_layout(uint64_t n) {
+	auto align = [](uint64_t x) { return (x + 7) / 8 * 8; };
+	uint64_t lifted = (uint64_t)basic_bottleneck_oracle<_Weight>::levels(n) * n;
+	oracle_file_header h;
+	std::memset(&h, 0, sizeof(h));
+	std::memcpy(h.magic, "MBPORACL", 8);
+	h.version = oracle_file_version;
+	h.byte_order = 0x01020304;
+	h.weight_bytes = sizeof(_Weight);
+	h.weight_kind = _weight_kind<_Weight>();
+	h.n = n;
+	h.depths = align(sizeof(oracle_file_header));
+	h.roots = align(h.depths + n * sizeof(int));
+	h.ancestors = align(h.roots + n * sizeof(int));
+	h.narrowest = align(h.ancestors + lifted * sizeof(int));
+	h.size = h.narrowest + lifted * sizeof(_Weight);
+	return h;
+}
+
+// write oracle to path
+template <typename _Weight>
+void save_oracle(basic_bottleneck_oracle<_Weight> const& oracle, const char* path) {
+	oracle_file_header h = oracle_file_layout<_Weight>(oracle.size());
+	mapped_file file(path, true, h.size);
+	auto put = [&](uint64_t pos, void const* src, size_t bytes) {
+		if (bytes > 0) std::memcpy(file.data() + pos, src, bytes);
+	};
+	put(0, &h, sizeof(h));
+	put(h.depths, oracle.depths().data(), h.n * sizeof(int));
+	put(h.roots, oracle.roots().data(), h.n * sizeof(int));
+	put(h.ancestors, oracle.ancestors().data(), oracle.ancestors().size() * sizeof(int));
+	put(h.narrowest, oracle.narrowest().data(), oracle.narrowest().size() * sizeof(_Weight));
+}
+
+// map the oracle written to path by save_oracle
+// Only the header is checked, the arrays are trusted to be consistent.
+template <typename _Weight = graph::weight_type>
+basic_bottleneck_oracle<_Weight> load_oracle(const char* path) {
+	auto file = std::make_shared<mapped_file>(path);
+	oracle_file_header h;
+	if (file->size() < sizeof(h)) throw generic_exception("not an oracle file");
+	std::memcpy(&h, file->data(), sizeof(h));
+	if (std::memcmp(h.magic, "MBPORACL", 8) != 0) throw generic_exception("not an oracle file");
+	if (h.version != oracle_file_version) throw generic_exception("unsupported oracle file version");
+	if (h.byte_order != 0x01020304) throw generic_exception("oracle file has foreign byte order");
+	if (h.weight_bytes != sizeof(_Weight) || h.weight_kind != _weight_kind<_Weight>())
+		throw generic_exception("oracle file holds another weight type");
+	if (h.n >= INT32_MAX || h.size != file->size())
+		throw generic_exception("corrupt oracle file header");
+	oracle_file_header expected = oracle_file_layout<_Weight>(h.n);
+	if (h.depths != expected.depths || h.roots != expected.roots ||
+		h.ancestors != expected.ancestors || h.narrowest != expected.narrowest ||
+		h.size != expected.size)
+		throw generic_exception("corrupt oracle file header");
+
+	char const* base = file->data();
+	uint64_t lifted = (uint64_t)basic_bottleneck_oracle<_Weight>::levels(h.n) * h.n;
+	return basic_bottleneck_oracle<_Weight>(
+		h.n, shared_array<int>((int const*)(base + h.depths), h.n, file),
+		shared_array<int>((int const*)(base + h.roots), h.n, file),
+		shared_array<int>((int const*)(base + h.ancestors), lifted, file),
+		shared_array<_Weight>((_Weight const*)(base + h.narrowest), lifted, file));
+}
+
+// Text formats accepted by import_graph
+// edge_list: one "u v [w]" edge per line with 0 based vertices and weight 1 if omitted,
+//            n is one more than the largest vertex; lines starting with # or % are skipped
+// dimacs:    "p sp n m" or "p edge n m", then "a u v w" arcs or "e u v [w]" edges with 1
+//            based vertices; lines starting with c are skipped
+enum class text_format { edge_list, dimacs };
+
+// call fn(u, v, w) for every edge of a text file, returns the n declared by a DIMACS
+// file or -1. Self loops are dropped. With symmetric_arcs every arc of a DIMACS file is
+// expected to be listed in both directions, as in the road networks of the DIMACS
+// challenge, and only the one with u < v is kept; otherwise every arc is its own edge.
+template <typename _Fn>
+int64_t _read_text_edges(const char* path, text_format format, bool symmetric_arcs,
+						 int64_t max_weight, _Fn fn) {
+	FILE* in = std::fopen(path, "r");
+	if (in == nullptr) throw generic_exception("cannot open graph text file");
+	char* line = nullptr;
+	size_t capacity = 0;
+	int64_t n = -1;
+	auto fail = [&](const char* message) {
+		std::free(line);
+		std::fclose(in);
+		throw generic_exception(message);
+	};
+	while (getline(&line, &capacity, in) != -1) {
+		char* p = line;
+		while (*p == ' ' || *p == '\t') ++p;
+		if (*p == '\n' || *p == '\r' || *p == '\0') continue;
+		bool arc = false;
+		if (format == text_format::edge_list) {
+			if (*p == '#' || *p == '%') continue;
+		} else {
+			if (*p == 'c') continue;
+			if (*p == 'p') {
+				// the problem name is followed by n and m
+				for (++p; *p == ' ' || *p == '\t'; ++p) {}
+				while (*p != '\0' && *p != ' ' && *p != '\t') ++p;
+				n = std::strtoll(p, &p, 10);
+				continue;
+			}
+			if (*p != 'a' && *p != 'e') fail("malformed line in graph text file");
+			arc = *p == 'a';
+			++p;
+		}
+		char* end;
+		int64_t u = std::strtoll(p, &end, 10);
+		if (end == p) fail("malformed line in graph text file");
+		int64_t v = std::strtoll(p = end, &end, 10);
+		if (end == p) fail("malformed line in graph text file");
+		int64_t w = std::strtoll(p = end, &end, 10);
+		if (end == p) w = 1;
+		if (format == text_format::dimacs) {
+			if (n < 0) fail("DIMACS edge before the problem line");
+			--u;
+			--v;
+			if (u >= n || v >= n) fail("vertex out of range in graph text file");
+		}
+		if (u < 0 || v < 0 || u >= INT32_MAX || v >= INT32_MAX)
+			fail("vertex out of range in graph text file");
+		if (w < 1 || w > max_weight) fail("edge weight out of range in graph text file");
+		if (u == v || (arc && symmetric_arcs && u > v)) continue;
+		fn((int)min(u, v), (int)max(u, v), w);
+	}
+	std::free(line);
+	std::fclose(in);
+	return n;
+}
+
+// convert a text graph into a graph file, duplicate edges are kept as parallel edges
+// The CSR weights are stored as _Weight, a 4 or 8 byte integer, which every weight must fit.
+template <typename _Weight = graph::weight_type>
+void import_graph(const char* input, const char* output, text_format format,
+				  bool symmetric_arcs = true) {
+	static_assert(std::is_integral<_Weight>::value && (sizeof(_Weight) == 4 || sizeof(_Weight) == 8),
+				  "graph files hold 4 or 8 byte integer weights");
+	const int64_t max_weight = std::numeric_limits<_Weight>::max();
+	// first pass: degrees, growing the array as larger vertices show up
+	vector<int> degree(1024, 0);
+	int64_t n = 0, m = 0;
+	int64_t declared =
+		_read_text_edges(input, format, symmetric_arcs, max_weight, [&](int u, int v, int64_t) {
+			if ((size_t)v >= degree.size()) {
+				vector<int> larger(max(2 * degree.size(), (size_t)v + 1), 0);
+				for (size_t i = 0; i < degree.size(); ++i) larger[i] = degree[i];
+				degree = std::move(larger);
+			}
+			++degree[u];
+			++degree[v];
+			n = max(n, (int64_t)v + 1);
+			++m;
+		});
+	if (declared >= 0) n = declared;
+	if (n >= INT32_MAX || 2 * m > INT32_MAX)
+		throw generic_exception("graph too large for a graph file");
+
+	// second pass: offsets from the degrees, then every edge goes to its place
+	graph_file_header h = graph_file_layout(n, m, sizeof(_Weight));
+	mapped_file file(output, true, h.size);
+	char* base = file.data();
+	std::memcpy(base, &h, sizeof(h));
+	int* offsets = (int*)(base + h.offsets);
+	int* targets = (int*)(base + h.targets);
+	_Weight* adjacency_weights = (_Weight*)(base + h.adjacency_weights);
+	pair<int, int>* edges = (pair<int, int>*)(base + h.edges);
+	int64_t* edge_weights = (int64_t*)(base + h.edge_weights);
+	offsets[0] = 0;
+	for (int64_t v = 0; v < n; ++v)
+		offsets[v + 1] = offsets[v] + (v < (int64_t)degree.size() ? degree[v] : 0);
+	degree = vector<int>();
+	vector<int> fill(n);
+	for (int64_t v = 0; v < n; ++v) fill[v] = offsets[v];
+	int64_t i = 0;
+	_read_text_edges(input, format, symmetric_arcs, max_weight, [&](int u, int v, int64_t w) {
+		targets[fill[u]] = v;
+		adjacency_weights[fill[u]++] = w;
+		targets[fill[v]] = u;
+		adjacency_weights[fill[v]++] = w;
+		edges[i] = pair<int, int>(u, v);
+		edge_weights[i++] = w;
+	});
+	if (i != m) throw generic_exception("graph text file changed while importing");
+}
@@ -0,0 +1,94 @@
+#pragma once
+// for uint64_t
+#include <cstdint>
+
+#include "hash_set.hh"
+#include "util.hh"
+#include "vector.hh"
+
+// Open addressing hash map from 64 bit keys to values
+// Laid out and probed like hash_set, with the values in a parallel table. Erasing shifts
+// the following entries of the probe run back, so no tombstones pile up.
+template <typename _Value>
+class hash_map {
+   private:
+	static constexpr uint64_t _empty = ~(uint64_t)0;
+	vector<uint64_t> _keys;
+	vector<_Value> _values;
+	size_t _mask = 0;
+	size_t _count = 0;
+	size_t _slot(uint64_t key) const {
+		size_t i = hash_key(key) & _mask;
+		while (_keys[i] != _empty && _keys[i] != key) i = (i + 1) & _mask;
+		return i;
+	}
+	void _rehash(size_t capacity) {
+		vector<uint64_t> old_keys = std::move(_keys);
+		vector<_Value> old_values = std::move(_values);
+		size_t old_capacity = _mask + 1;
+		_keys = vector<uint64_t>(capacity, _empty);
+		_values = vector<_Value>(capacity);
+		_mask = capacity - 1;
+		if (_count == 0) return;
+		for (size_t i = 0; i < old_capacity; ++i) {
+			if (old_keys[i] == _empty) continue;
+			size_t j = _slot(old_keys[i]);
+			_keys[j] = old_keys[i];
+			_values[j] = old_values[i];
+		}
+	}
+
+   public:
+	// sized so that expected keys fit without rehashing
+	hash_map(size_t expected = 0) { reserve(expected); }
+	void reserve(size_t expected) {
+		size_t capacity = 16;
+		while (capacity < 2 * expected) capacity <<= 1;
+		if (capacity > _mask + 1 || _keys.size() == 0) _rehash(capacity);
+	}
+	size_t size() const { return _count; }
+	bool contains(uint64_t key) const { return _keys[_slot(key)] == key; }
+	// value of key, nullptr if absent
+	_Value* find(uint64_t key) const {
+		size_t i = _slot(key);
+		return _keys[i] == key ? &_values[i] : nullptr;
+	}
+	// set the value of key, returns false if key was already present
+	bool insert(uint64_t key, _Value const& value) {
+		assert(key != _empty);
+		size_t i = _slot(key);
+		if (_keys[i] == key) {
+			_values[i] = value;
+			return false;
+		}
+		if (2 * (_count + 1) > _mask + 1) {
+			_rehash(2 * (_mask + 1));
+			i = _slot(key);
+		}
+		_keys[i] = key;
+		_values[i] = value;
+		++_count;
+		return true;
+	}
+	// returns false if key was absent
+	bool erase(uint64_t key) {
+		size_t i = _slot(key);
+		if (_keys[i] != key) return false;
+		// move back every later entry of the run whose home slot is not in (i, j]
+		for (size_t j = (i + 1) & _mask; _keys[j] != _empty; j = (j + 1) & _mask) {
+			size_t home = hash_key(_keys[j]) & _mask;
+			if (((j - home) & _mask) >= ((j - i) & _mask)) {
+				_keys[i] = _keys[j];
+				_values[i] = _values[j];
+				i = j;
+			}
+		}
+		_keys[i] = _empty;
+		--_count;
+		return true;
+	}
+	void clear() {
+		for (size_t i = 0; i <= _mask; ++i) _keys[i] = _empty;
+		_count = 0;
+	}
+};
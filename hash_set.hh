@@ -0,0 +1,70 @@
+#pragma once
+// for uint64_t
+#include <cstdint>
+
+#include "util.hh"
+#include "vector.hh"
+
+// splitmix64 finalizer, spreads packed (u, v) pairs over the whole table
+inline uint64_t hash_key(uint64_t x) {
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return x;
+}
+
+// Open addressing hash set of 64 bit keys
+// Keys live in one flat power of two table probed linearly, so a lookup is usually a
+// single cache miss and inserting never allocates a node. The table doubles whenever it
+// becomes half full. The all ones key is reserved to mark empty slots.
+class hash_set {
+   private:
+	static constexpr uint64_t _empty = ~(uint64_t)0;
+	vector<uint64_t> _table;
+	size_t _mask = 0;
+	size_t _count = 0;
+	size_t _slot(uint64_t key) const {
+		size_t i = hash_key(key) & _mask;
+		while (_table[i] != _empty && _table[i] != key) i = (i + 1) & _mask;
+		return i;
+	}
+	void _rehash(size_t capacity) {
+		vector<uint64_t> old = std::move(_table);
+		size_t old_capacity = _mask + 1;
+		_table = vector<uint64_t>(capacity, _empty);
+		_mask = capacity - 1;
+		if (_count == 0) return;
+		for (size_t i = 0; i < old_capacity; ++i)
+			if (old[i] != _empty) _table[_slot(old[i])] = old[i];
+	}
+
+   public:
+	// sized so that expected keys fit without rehashing
+	hash_set(size_t expected = 0) { reserve(expected); }
+	void reserve(size_t expected) {
+		size_t capacity = 16;
+		while (capacity < 2 * expected) capacity <<= 1;
+		if (capacity > _mask + 1 || _table.size() == 0) _rehash(capacity);
+	}
+	size_t size() const { return _count; }
+	bool contains(uint64_t key) const { return _table[_slot(key)] == key; }
+	// returns false if the key was already present
+	bool insert(uint64_t key) {
+		assert(key != _empty);
+		size_t i = _slot(key);
+		if (_table[i] == key) return false;
+		if (2 * (_count + 1) > _mask + 1) {
+			_rehash(2 * (_mask + 1));
+			i = _slot(key);
+		}
+		_table[i] = key;
+		++_count;
+		return true;
+	}
+	void clear() {
+		for (size_t i = 0; i <= _mask; ++i) _table[i] = _empty;
+		_count = 0;
+	}
+};
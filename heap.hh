@@ -1,9 +1,17 @@
+#pragma once
+#include "stats.hh"
 #include "util.hh"
 #include "vector.hh"
 // Heap implementation using vector
 // H, D, P as described in problem statement
+// Every heap usable by graph (dary_heap, pairing_heap, radix_heap) provides
+// value_type, heap(n), heap(data) for any array of values, size, reset, peek, extract_max, insert
+// and increase_key.
 template <typename _Value>
 class heap {
+   public:
+	using value_type = _Value;
+
    private:
 	vector<int> H;
 	vector<_Value> D;
@@ -15,9 +23,14 @@ class heap {
 
    public:
 	heap(int n) : H(n), D(n), P(n, -1) {}
-	heap(vector<_Value> const& data)
-		: H(data.size()), D(data), P(data.size(), -1), _size(data.size()) {
-		for (int i = 0; i < _size; ++i) { H[i] = P[i] = i; }
+	// heapify the values of any array with size() and operator[]
+	template <typename _Data>
+	heap(_Data const& data)
+		: H(data.size()), D(data.size()), P(data.size(), -1), _size(data.size()) {
+		for (int i = 0; i < _size; ++i) {
+			H[i] = P[i] = i;
+			D[i] = data[i];
+		}
 		for (int i = _size / 2; i >= 0; --i) {
 			int tmp = i;
 			while (tmp < _size) {
@@ -25,6 +38,7 @@ class heap {
 				if (left(tmp) < _size && D[H[left(tmp)]] > D[H[max_tmp]]) max_tmp = left(tmp);
 				if (right(tmp) < _size && D[H[right(tmp)]] > D[H[max_tmp]]) max_tmp = right(tmp);
 				if (max_tmp == tmp) break;
+				STAT_INC(heap_sift_steps);
 				std::swap(P[H[tmp]], P[H[max_tmp]]);
 				std::swap(H[tmp], H[max_tmp]);
 				tmp = max_tmp;
@@ -39,10 +53,16 @@ class heap {
 		return {res, val};
 	}
 	int size() { return this->_size; }
+	// empty the heap, keeping its storage
+	void reset() {
+		for (int i = 0; i < _size; ++i) P[H[i]] = -1;
+		_size = 0;
+	}
 	void increase_key(int x, _Value value) {
 		int index = P[x];
 		D[x] = value;
 		while (index != 0 && D[H[index]] > D[H[parent(index)]]) {
+			STAT_INC(heap_sift_steps);
 			std::swap(P[H[index]], P[H[parent(index)]]);
 			std::swap(H[index], H[parent(index)]);
 			index = parent(index);
@@ -57,6 +77,7 @@ class heap {
 		P[x] = _size - 1;
 		int index = _size - 1;
 		while (index != 0 && D[H[parent(index)]] < D[H[index]]) {
+			STAT_INC(heap_sift_steps);
 			std::swap(P[H[index]], P[H[parent(index)]]);
 			std::swap(H[index], H[parent(index)]);
 			index = parent(index);
@@ -68,6 +89,7 @@ class heap {
 		std::swap(H[index], H[_size - 1]);
 		--_size;
 		while (index != 0 && D[H[index]] > D[H[parent(index)]]) {
+			STAT_INC(heap_sift_steps);
 			std::swap(P[H[index]], P[H[parent(index)]]);
 			std::swap(H[index], H[parent(index)]);
 			index = parent(index);
@@ -78,6 +100,7 @@ class heap {
 			if (right(index) < _size && D[H[right(index)]] > D[H[max_index]])
 				max_index = right(index);
 			if (max_index == index) break;
+			STAT_INC(heap_sift_steps);
 			std::swap(P[H[index]], P[H[max_index]]);
 			std::swap(H[index], H[max_index]);
 			index = max_index;
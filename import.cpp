@@ -0,0 +1,70 @@
+// Converts a text graph into the binary graph file read by load_graph
+// The input is an edge list ("u v [w]" per line, 0 based) or, with --dimacs, a DIMACS
+// file. DIMACS arcs are expected in both directions unless --asymmetric is given.
+// With --forest only the maximum spanning forest is kept (streaming_forest.hh), in memory
+// linear in the vertices, and written as an oracle file for load_oracle; the input may
+// also be a graph file then.
+//
+//   ./import --dimacs USA-road-d.NY.gr ny.graph
+//   ./a.out ny.graph
+//   ./import --forest --dimacs USA-road-d.USA.gr usa.oracle
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "graph_file.hh"
+#include "streaming_forest.hh"
+
+int main(int argc, char** argv) {
+	text_format format = text_format::edge_list;
+	bool symmetric_arcs = true, forest_only = false;
+	const char* files[2];
+	int n_files = 0;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--dimacs") == 0) format = text_format::dimacs;
+		else if (std::strcmp(argv[i], "--asymmetric") == 0)
+			symmetric_arcs = false;
+		else if (std::strcmp(argv[i], "--forest") == 0)
+			forest_only = true;
+		else if (n_files < 2 && argv[i][0] != '-')
+			files[n_files++] = argv[i];
+		else
+			n_files = 3;
+	}
+	if (n_files != 2) {
+		std::cerr << "usage: " << argv[0] << " [--dimacs] [--asymmetric] [--forest] input output"
+				  << std::endl;
+		return 2;
+	}
+	try {
+		auto t0 = std::chrono::steady_clock::now();
+		if (forest_only) {
+			// a graph file is recognized by its magic
+			char magic[8] = {};
+			FILE* in = std::fopen(files[0], "rb");
+			bool graph_file = in != nullptr && std::fread(magic, 1, 8, in) == 8 &&
+							  std::memcmp(magic, "MBPGRAPH", 8) == 0;
+			if (in != nullptr) std::fclose(in);
+			csr<graph::weight_type> tree =
+				graph_file ? stream_spanning_forest(files[0])
+						   : stream_spanning_forest(files[0], format, symmetric_arcs);
+			save_oracle(bottleneck_oracle(tree), files[1]);
+			auto t1 = std::chrono::steady_clock::now();
+			std::cout << "Kept " << tree.edges() / 2 << " forest edges over " << tree.size()
+					  << " vertices in: "
+					  << std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count()
+					  << " ms" << std::endl;
+			return 0;
+		}
+		import_graph(files[0], files[1], format, symmetric_arcs);
+		auto t1 = std::chrono::steady_clock::now();
+		graph G = load_graph(files[1]);
+		std::cout << "Imported " << G.num_vertices() << " vertices and " << G.num_edges()
+				  << " edges in: "
+				  << std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count() << " ms"
+				  << std::endl;
+	} catch (std::exception const& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,158 @@
+#pragma once
+// for std::numeric_limits
+#include <limits>
+
+#include "util.hh"
+#include "vector.hh"
+
+// Link-cut tree over a forest of valued nodes, with path minimum queries
+// Every preferred path of the forest is kept in a splay tree ordered by depth, linked to
+// the rest through the path parent in P. Nodes are indices; the trees live in flat arrays,
+// so nothing is allocated per operation. link, cut, connected and path_min are
+// O(log n) amortized.
+template <typename _Value>
+class link_cut_tree {
+   private:
+	// children and parent (splay parent, or path parent for a splay root)
+	vector<int> L, R, P;
+	// pending reversal of the subtree, set when a tree is rerooted
+	vector<char> flip;
+	vector<_Value> D;
+	// node of minimum value in the splay subtree
+	vector<int> M;
+	// scratch stack for pushing reversals down before a splay
+	vector<int> _stack;
+	bool _is_root(int x) const { return P[x] == -1 || (L[P[x]] != x && R[P[x]] != x); }
+	void _pull(int x) {
+		M[x] = x;
+		if (L[x] != -1 && D[M[L[x]]] < D[M[x]]) M[x] = M[L[x]];
+		if (R[x] != -1 && D[M[R[x]]] < D[M[x]]) M[x] = M[R[x]];
+	}
+	void _push(int x) {
+		if (!flip[x]) return;
+		std::swap(L[x], R[x]);
+		if (L[x] != -1) flip[L[x]] ^= 1;
+		if (R[x] != -1) flip[R[x]] ^= 1;
+		flip[x] = 0;
+	}
+	void _rotate(int x) {
+		int y = P[x], z = P[y];
+		if (!_is_root(y)) {
+			if (L[z] == y) L[z] = x;
+			else
+				R[z] = x;
+		}
+		P[x] = z;
+		if (L[y] == x) {
+			L[y] = R[x];
+			if (R[x] != -1) P[R[x]] = y;
+			R[x] = y;
+		} else {
+			R[y] = L[x];
+			if (L[x] != -1) P[L[x]] = y;
+			L[x] = y;
+		}
+		P[y] = x;
+		_pull(y);
+		_pull(x);
+	}
+	void _splay(int x) {
+		int top = 0;
+		_stack[top++] = x;
+		for (int y = x; !_is_root(y); y = P[y]) _stack[top++] = P[y];
+		while (top > 0) _push(_stack[--top]);
+		while (!_is_root(x)) {
+			int y = P[x], z = P[y];
+			if (!_is_root(y)) _rotate((L[y] == x) == (L[z] == y) ? y : x);
+			_rotate(x);
+		}
+	}
+	// make the path from the root to x preferred, x ends up as root of its splay tree
+	void _access(int x) {
+		for (int last = -1, y = x; y != -1; last = y, y = P[y]) {
+			_splay(y);
+			R[y] = last;
+			_pull(y);
+		}
+		_splay(x);
+	}
+	// make x the root of its tree
+	void _evert(int x) {
+		_access(x);
+		flip[x] ^= 1;
+	}
+	int _find_root(int x) {
+		_access(x);
+		for (_push(x); L[x] != -1; _push(x)) x = L[x];
+		_splay(x);
+		return x;
+	}
+
+   public:
+	link_cut_tree() {}
+	// n isolated nodes of value max
+	link_cut_tree(int n)
+		: L(n, -1), R(n, -1), P(n, -1), flip(n, 0), D(n, std::numeric_limits<_Value>::max()), M(n),
+		  _stack(n) {
+		for (int x = 0; x < n; ++x) M[x] = x;
+	}
+	int size() const { return D.size(); }
+	// append an isolated node, returns its index
+	int add(_Value value) {
+		L.push_back(-1);
+		R.push_back(-1);
+		P.push_back(-1);
+		flip.push_back(0);
+		D.push_back(value);
+		M.push_back(D.size() - 1);
+		_stack.push_back(0);
+		return D.size() - 1;
+	}
+	_Value value(int x) const { return D[x]; }
+	void set_value(int x, _Value value) {
+		_access(x);
+		D[x] = value;
+		_pull(x);
+	}
+	bool connected(int a, int b) { return a == b || _find_root(a) == _find_root(b); }
+	// a and b must be in different trees
+	void link(int a, int b) {
+		_evert(a);
+		P[a] = b;
+	}
+	// a and b must be adjacent
+	void cut(int a, int b) {
+		_evert(a);
+		_access(b);
+		// the path is just a - b, so a is the whole left subtree of b
+		assert(L[b] == a && R[a] == -1 && L[a] == -1);
+		L[b] = P[a] = -1;
+		_pull(b);
+	}
+	// node of minimum value on the path between a and b, which must be connected
+	int path_min(int a, int b) {
+		_evert(a);
+		_access(b);
+		return M[b];
+	}
+	// nodes on the path from a to b, which must be connected
+	vector<int> path(int a, int b) {
+		_evert(a);
+		_access(b);
+		// in order walk of the splay tree of b
+		vector<int> nodes;
+		int top = 0;
+		for (int x = b; x != -1 || top > 0;) {
+			if (x != -1) {
+				_push(x);
+				_stack[top++] = x;
+				x = L[x];
+			} else {
+				x = _stack[--top];
+				nodes.push_back(x);
+				x = R[x];
+			}
+		}
+		return nodes;
+	}
+};
@@ -0,0 +1,190 @@
+#pragma once
+// for int64_t
+#include <cstdint>
+
+#include "queue.hh"
+#include "util.hh"
+#include "vector.hh"
+
+// maximum flow between two vertices and a minimum cut separating them
+template <typename _Capacity = int64_t>
+struct flow_result {
+	_Capacity value = 0;
+	// vertices on the side of s
+	vector<int> source_side;
+	// edges of the cut as (u, v) with u on the side of s
+	vector<pair<int, int>> cut;
+};
+
+// Flow over an undirected graph whose edge weights are capacities
+// Every edge is a pair of opposite arcs in compressed sparse row form, with the index of
+// the reverse arc stored alongside, so pushing flow one way frees the same amount the other
+// way. max_flow runs Dinic's algorithm: a BFS levels the residual graph from s, then an
+// iterative DFS finds a blocking flow along level increasing arcs, resuming every vertex
+// at its current arc so no arc is tried twice in a phase. _Capacity must hold the sum of
+// the capacities out of s.
+template <typename _Capacity = int64_t>
+class flow_network {
+   private:
+	int _n = 0;
+	vector<int> _offset, _target, _rev;
+	vector<_Capacity> _cap, _flow;
+	// arc from the first to the second endpoint of every edge
+	vector<int> _edge_arc;
+	vector<int> _level, _current;
+	_Capacity _residual(int a) const { return _cap[a] - _flow[a]; }
+	void _push(int a, _Capacity f) {
+		_flow[a] += f;
+		_flow[_rev[a]] -= f;
+	}
+	// push the residual of arcs[k], the narrowest, along all arcs and leave arcs[k] full
+	// With floating point capacities the others may keep a trace of room or lack one, but
+	// the narrowest arc is saturated exactly, so every push fills at least one arc.
+	_Capacity _push_all(vector<int> const& arcs, int k) {
+		_Capacity f = _residual(arcs[k]);
+		for (int a : arcs) _push(a, f);
+		_flow[arcs[k]] = _cap[arcs[k]];
+		_flow[_rev[arcs[k]]] = -_cap[arcs[k]];
+		return f;
+	}
+	// levels from s over arcs with room left, true if t is reached
+	bool _bfs(int s, int t) {
+		for (int v = 0; v < _n; ++v) _level[v] = -1;
+		ring_queue<int> q(_n);
+		_level[s] = 0;
+		q.push(s);
+		while (q.size() > 0) {
+			int u = q.pop();
+			// vertices beyond t's level cannot be on a shortest path to it
+			if (_level[t] != -1 && _level[u] >= _level[t]) break;
+			for (int a = _offset[u]; a < _offset[u + 1]; ++a) {
+				int v = _target[a];
+				if (_level[v] == -1 && _residual(a) > 0) {
+					_level[v] = _level[u] + 1;
+					q.push(v);
+				}
+			}
+		}
+		return _level[t] != -1;
+	}
+	// blocking flow along the levels, returns the amount pushed
+	_Capacity _blocking(int s, int t) {
+		for (int v = 0; v < _n; ++v) _current[v] = _offset[v];
+		_Capacity total = 0;
+		// arcs of the path from s to u
+		vector<int> path;
+		int u = s;
+		while (true) {
+			if (u == t) {
+				int k = 0;
+				for (int i = 1; i < (int)path.size(); ++i)
+					if (_residual(path[i]) < _residual(path[k])) k = i;
+				total += _push_all(path, k);
+				// back to the tail of the first saturated arc
+				while ((int)path.size() > k) path.pop_back();
+				u = k == 0 ? s : _target[path[k - 1]];
+				continue;
+			}
+			int& a = _current[u];
+			while (a < _offset[u + 1] &&
+				   (_residual(a) <= 0 || _level[_target[a]] != _level[u] + 1))
+				++a;
+			if (a < _offset[u + 1]) {
+				path.push_back(a);
+				u = _target[a];
+				continue;
+			}
+			// dead end, no path to t goes through u in this phase
+			_level[u] = -1;
+			if (path.size() == 0) break;
+			path.pop_back();
+			u = path.size() == 0 ? s : _target[path[path.size() - 1]];
+			++_current[u];
+		}
+		return total;
+	}
+
+   public:
+	flow_network() {}
+	// edge i joins edges[i].first and edges[i].second with capacity capacities[i] both ways
+	template <typename _Edges, typename _Capacities>
+	flow_network(int n, _Edges const& edges, _Capacities const& capacities)
+		: _n(n), _offset(n + 1, 0), _level(n), _current(n) {
+		int m = edges.size();
+		_target = vector<int>(2 * m);
+		_rev = vector<int>(2 * m);
+		_cap = vector<_Capacity>(2 * m);
+		_flow = vector<_Capacity>(2 * m, 0);
+		_edge_arc = vector<int>(m);
+		for (int i = 0; i < m; ++i) {
+			++_offset[edges[i].first + 1];
+			++_offset[edges[i].second + 1];
+		}
+		for (int v = 0; v < n; ++v) _offset[v + 1] += _offset[v];
+		vector<int> fill(n);
+		for (int v = 0; v < n; ++v) fill[v] = _offset[v];
+		for (int i = 0; i < m; ++i) {
+			int u = edges[i].first, v = edges[i].second;
+			int a = fill[u]++, b = fill[v]++;
+			_target[a] = v;
+			_target[b] = u;
+			_rev[a] = b;
+			_rev[b] = a;
+			_cap[a] = _cap[b] = capacities[i];
+			_edge_arc[i] = a;
+		}
+	}
+	int size() const { return _n; }
+	// flow on edge i, negative if it goes from the second endpoint to the first
+	_Capacity flow(int i) const { return _flow[_edge_arc[i]]; }
+	// push as much as fits along the vertices of path, returns the amount
+	// e.g. to start from the widest path, which carries the most a single path can
+	_Capacity push_path(vector<int> const& path) {
+		vector<int> arcs;
+		int k = -1;
+		for (int i = 0; i + 1 < (int)path.size(); ++i) {
+			// of parallel edges the one with the most room
+			int best = -1;
+			for (int a = _offset[path[i]]; a < _offset[path[i] + 1]; ++a)
+				if (_target[a] == path[i + 1] && (best == -1 || _residual(a) > _residual(best)))
+					best = a;
+			assert(best != -1);
+			arcs.push_back(best);
+			if (k == -1 || _residual(best) < _residual(arcs[k])) k = arcs.size() - 1;
+		}
+		if (arcs.size() == 0 || _residual(arcs[k]) <= 0) return 0;
+		return _push_all(arcs, k);
+	}
+	// complete the flow from s to t, returns its value including what was pushed before
+	_Capacity max_flow(int s, int t) {
+		assert(s != t);
+		while (_bfs(s, t)) _blocking(s, t);
+		_Capacity value = 0;
+		for (int a = _offset[s]; a < _offset[s + 1]; ++a) value += _flow[a];
+		return value;
+	}
+	// the minimum cut left by max_flow(s, t): what s still reaches and the full edges out
+	flow_result<_Capacity> min_cut(int s) {
+		flow_result<_Capacity> ans;
+		vector<char> side(_n, 0);
+		ring_queue<int> q(_n);
+		side[s] = 1;
+		q.push(s);
+		while (q.size() > 0) {
+			int u = q.pop();
+			ans.source_side.push_back(u);
+			for (int a = _offset[u]; a < _offset[u + 1]; ++a)
+				if (!side[_target[a]] && _residual(a) > 0) {
+					side[_target[a]] = 1;
+					q.push(_target[a]);
+				}
+		}
+		for (int u : ans.source_side)
+			for (int a = _offset[u]; a < _offset[u + 1]; ++a)
+				if (!side[_target[a]]) {
+					ans.cut.push_back({u, _target[a]});
+					ans.value += _cap[a];
+				}
+		return ans;
+	}
+};
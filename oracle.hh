@@ -0,0 +1,171 @@
+#pragma once
+// for int64_t
+#include <cstdint>
+// for std::numeric_limits
+#include <limits>
+
+#include "queue.hh"
+#include "shared_array.hh"
+#include "util.hh"
+#include "vector.hh"
+
+// Bottleneck queries on a maximum spanning tree
+// The widest path between any two vertices of the graph has the same bandwidth as the
+// unique path between them in the tree, so the tree is rooted once and indexed using
+// binary lifting. Every query is then O(log n) instead of a fresh Kruskal + BFS, a whole
+// path O(length + log n): the lifting finds the LCA, the parents lead to it.
+// The arrays are frozen once built, so an oracle can be saved with save_oracle and mapped
+// back with load_oracle (graph_file.hh) instead of being rebuilt.
+// graph.hh names the instance for graph's weights bottleneck_oracle.
+template <typename _Weight = int64_t>
+class basic_bottleneck_oracle {
+   private:
+	int _n = 0;
+	int _log = 1;
+	shared_array<int> depth;
+	// component of every vertex, queries across components have no path
+	shared_array<int> root;
+	// up[k * _n + v] is the 2^k-th ancestor of v
+	// low[k * _n + v] is the narrowest edge on the way to it
+	shared_array<int> up;
+	shared_array<_Weight> low;
+	static int _levels(int n) {
+		int log = 1;
+		while ((1 << log) < n) ++log;
+		return log;
+	}
+	// lift v by d levels, narrowing bw along the way
+	int _lift(int v, int d, _Weight& bw) const {
+		for (int k = 0; d > 0; ++k, d >>= 1) {
+			if (d & 1) {
+				bw = min(bw, low[k * _n + v]);
+				v = up[k * _n + v];
+			}
+		}
+		return v;
+	}
+	// lowest common ancestor of connected s and t, and the bandwidth between them in bw
+	int _meet(int s, int t, _Weight& bw) const {
+		bw = std::numeric_limits<_Weight>::max();
+		if (depth[s] < depth[t]) std::swap(s, t);
+		s = _lift(s, depth[s] - depth[t], bw);
+		if (s == t) return s;
+		for (int k = _log - 1; k >= 0; --k) {
+			if (up[k * _n + s] != up[k * _n + t]) {
+				bw = min(bw, min(low[k * _n + s], low[k * _n + t]));
+				s = up[k * _n + s];
+				t = up[k * _n + t];
+			}
+		}
+		bw = min(bw, min(low[s], low[t]));
+		return up[s];
+	}
+	// first of the d edges above v no wider than bw, as its lower end; -1 if there is none
+	// The narrowest edge of every jump tells whether the jump can be skipped whole.
+	int _first_within(int v, int d, _Weight bw) const {
+		for (int k = _log - 1; k >= 0; --k) {
+			if ((1 << k) <= d && low[k * _n + v] > bw) {
+				v = up[k * _n + v];
+				d -= 1 << k;
+			}
+		}
+		return d > 0 ? v : -1;
+	}
+
+   public:
+	basic_bottleneck_oracle() {}
+	// tree is any adjacency whose rows hold (vertex, weight) pairs
+	template <typename _Adjacency>
+	basic_bottleneck_oracle(_Adjacency const& tree) : _n(tree.size()), _log(_levels(_n)) {
+		vector<int> depth(_n, -1), root(_n, -1), up(_log * _n, 0);
+		vector<_Weight> low(_log * _n, std::numeric_limits<_Weight>::max());
+		// root every component of the forest with a BFS
+		ring_queue<int> q(_n);
+		for (int r = 0; r < _n; ++r) {
+			if (depth[r] != -1) continue;
+			depth[r] = 0;
+			root[r] = r;
+			up[r] = r;
+			q.push(r);
+			while (q.size() > 0) {
+				int u = q.pop();
+				for (auto e : tree[u]) {
+					if (depth[e.first] == -1) {
+						depth[e.first] = depth[u] + 1;
+						root[e.first] = r;
+						up[e.first] = u;
+						low[e.first] = e.second;
+						q.push(e.first);
+					}
+				}
+			}
+		}
+		for (int k = 1; k < _log; ++k) {
+			for (int v = 0; v < _n; ++v) {
+				int mid = up[(k - 1) * _n + v];
+				up[k * _n + v] = up[(k - 1) * _n + mid];
+				low[k * _n + v] = min(low[(k - 1) * _n + v], low[(k - 1) * _n + mid]);
+			}
+		}
+		this->depth = std::move(depth);
+		this->root = std::move(root);
+		this->up = std::move(up);
+		this->low = std::move(low);
+	}
+	// oracle over arrays built before, e.g. mapped from a file by load_oracle
+	// up and low hold levels(n) * n entries
+	basic_bottleneck_oracle(int n, shared_array<int> depth, shared_array<int> root,
+							shared_array<int> up, shared_array<_Weight> low)
+		: _n(n), _log(_levels(n)), depth(std::move(depth)), root(std::move(root)),
+		  up(std::move(up)), low(std::move(low)) {
+		assert(this->depth.size() == (size_t)n && this->root.size() == (size_t)n &&
+			   this->up.size() == (size_t)_log * n && this->low.size() == (size_t)_log * n);
+	}
+	// number of lifting levels of an oracle over n vertices
+	static int levels(int n) { return _levels(n); }
+	// the frozen arrays, e.g. to write them to a file
+	shared_array<int> const& depths() const { return depth; }
+	shared_array<int> const& roots() const { return root; }
+	shared_array<int> const& ancestors() const { return up; }
+	shared_array<_Weight> const& narrowest() const { return low; }
+	int size() const { return _n; }
+	bool connected(int s, int t) const { return root[s] == root[t]; }
+	// lowest common ancestor of s and t, they must be connected
+	int lca(int s, int t) const {
+		_Weight bw;
+		return _meet(s, t, bw);
+	}
+	// bandwidth of the widest s-t path, 0 if there is none
+	_Weight query(int s, int t) const {
+		if (!connected(s, t)) return 0;
+		_Weight bw;
+		_meet(s, t, bw);
+		return bw;
+	}
+	// a narrowest edge of the widest s-t path as (u, v), u coming first on the way from s,
+	// (-1, -1) if there is no edge on the way
+	pair<int, int> bottleneck_edge(int s, int t) const {
+		if (s == t || !connected(s, t)) return pair<int, int>(-1, -1);
+		_Weight bw;
+		int a = _meet(s, t, bw);
+		int x = _first_within(s, depth[s] - depth[a], bw);
+		if (x != -1) return pair<int, int>(x, up[x]);
+		x = _first_within(t, depth[t] - depth[a], bw);
+		return pair<int, int>(up[x], x);
+	}
+	// widest s-t path, recovered by walking the tree up to the LCA; empty and 0 wide if
+	// there is none
+	pair<vector<int>, _Weight> path(int s, int t) const {
+		if (!connected(s, t)) return pair<vector<int>, _Weight>(vector<int>(), 0);
+		_Weight bw;
+		int a = _meet(s, t, bw);
+		vector<int> ans;
+		ans.reserve(depth[s] + depth[t] - 2 * depth[a] + 1);
+		for (int c = s; c != a; c = up[c]) ans.push_back(c);
+		ans.push_back(a);
+		int mid = ans.size();
+		for (int c = t; c != a; c = up[c]) ans.push_back(c);
+		reverse(ans.begin() + mid, ans.end());
+		return pair<vector<int>, _Weight>(ans, bw);
+	}
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include "util.hh"
+#include "vector.hh"
+// Indexed pairing max heap
+// Nodes are the vertices themselves, linked through the child / sibling / prev arrays,
+// so no memory is allocated after construction. insert and increase_key are O(1),
+// extract_max is O(log n) amortized.
+template <typename _Value>
+class pairing_heap {
+   public:
+	using value_type = _Value;
+
+   private:
+	vector<_Value> D;
+	// first child, next sibling and previous sibling (or parent for a first child)
+	vector<int> child, sibling, prev;
+	// scratch list used while pairing the children of an extracted root
+	vector<int> pairs;
+	int root = -1;
+	int _size = 0;
+	// make the smaller root the first child of the larger one
+	int _link(int a, int b) {
+		if (a == -1) return b;
+		if (b == -1) return a;
+		if (D[a] < D[b]) std::swap(a, b);
+		sibling[b] = child[a];
+		if (child[a] != -1) prev[child[a]] = b;
+		child[a] = b;
+		prev[b] = a;
+		sibling[a] = prev[a] = -1;
+		return a;
+	}
+	// detach x (and its subtree) from its parent and siblings
+	void _cut(int x) {
+		if (child[prev[x]] == x) child[prev[x]] = sibling[x];
+		else
+			sibling[prev[x]] = sibling[x];
+		if (sibling[x] != -1) prev[sibling[x]] = prev[x];
+		sibling[x] = prev[x] = -1;
+	}
+
+   public:
+	pairing_heap(int n) : D(n), child(n, -1), sibling(n, -1), prev(n, -1), pairs(n) {}
+	template <typename _Data>
+	pairing_heap(_Data const& data) : pairing_heap((int)data.size()) {
+		for (int i = 0; i < (int)data.size(); ++i) insert(i, data[i]);
+	}
+	pair<int, _Value> peek() { return {root, D[root]}; }
+	pair<int, _Value> extract_max() {
+		pair<int, _Value> res = peek();
+		// two pass pairing: link neighbours left to right, then fold right to left
+		int count = 0;
+		for (int c = child[root]; c != -1;) {
+			int a = c, b = sibling[c];
+			c = b == -1 ? -1 : sibling[b];
+			sibling[a] = prev[a] = -1;
+			if (b != -1) sibling[b] = prev[b] = -1;
+			pairs[count++] = _link(a, b);
+		}
+		int new_root = -1;
+		for (int i = count - 1; i >= 0; --i) new_root = _link(pairs[i], new_root);
+		child[root] = -1;
+		root = new_root;
+		--_size;
+		return res;
+	}
+	int size() { return this->_size; }
+	// empty the heap, keeping its storage (insert relinks every node it is given)
+	void reset() {
+		root = -1;
+		_size = 0;
+	}
+	void increase_key(int x, _Value value) {
+		D[x] = value;
+		if (x == root) return;
+		_cut(x);
+		root = _link(root, x);
+	}
+	void insert(int x, _Value value) {
+		++_size;
+		D[x] = value;
+		child[x] = sibling[x] = prev[x] = -1;
+		root = _link(root, x);
+	}
+};
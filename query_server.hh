@@ -0,0 +1,142 @@
+#pragma once
+// for the worker pool
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "graph.hh"
+#include "util.hh"
+#include "vector.hh"
+#include "workspace.hh"
+
+// Answers independent bandwidth queries on a read only graph with a pool of threads
+// Every worker owns a query_workspace, so queries do not allocate scratch arrays. A batch
+// of jobs is split into one contiguous range per worker; a worker that runs out steals
+// half of the remaining range of another one. Results are written to the slot of their
+// job, so they come back in query order. The graph's weights are the heap's value_type.
+template <typename _Heap = heap<graph::weight_type>>
+class query_server {
+   public:
+	using weight_type = typename _Heap::value_type;
+
+   private:
+	class worker;
+	basic_graph<weight_type> const& _g;
+	int _threads;
+	vector<worker*> _workers;
+	vector<std::thread> _pool;
+	// batch hand off
+	std::mutex _lock;
+	std::condition_variable _wake, _done;
+	int _generation = 0;
+	int _running = 0;
+	bool _stop = false;
+	vector<pair<int, int>> const* _queries = nullptr;
+	vector<pair<vector<int>, weight_type>>* _results = nullptr;
+	// next job of worker id, stealing from the others once its own range is empty
+	int _next_job(int id);
+	void _work(int id);
+
+   public:
+	// threads = 0 uses every hardware thread
+	query_server(basic_graph<weight_type> const& g, int threads = 0);
+	int threads() const { return _threads; }
+	// answer every (s, t) query, blocks until the whole batch is done
+	vector<pair<vector<int>, weight_type>> run(vector<pair<int, int>> const& queries);
+	~query_server();
+};
+
+template <typename _Heap>
+class query_server<_Heap>::worker {
+   public:
+	std::mutex lock;
+	// jobs [begin, end) still owned by this worker
+	int begin = 0, end = 0;
+	query_workspace<_Heap> ws;
+	worker(int n) : ws(n) {}
+};
+
+template <typename _Heap>
+query_server<_Heap>::query_server(basic_graph<weight_type> const& g, int threads)
+	: _g(g), _threads(threads > 0 ? threads : max(1, (int)std::thread::hardware_concurrency())) {
+	_workers = vector<worker*>(_threads);
+	for (int i = 0; i < _threads; ++i) _workers[i] = new worker(g.num_vertices());
+	_pool.reserve(_threads);
+	for (int i = 0; i < _threads; ++i) _pool.push_back(std::thread([this, i] { _work(i); }));
+}
+
+template <typename _Heap>
+int query_server<_Heap>::_next_job(int id) {
+	worker& self = *_workers[id];
+	{
+		std::lock_guard<std::mutex> guard(self.lock);
+		if (self.begin < self.end) return self.begin++;
+	}
+	for (int k = 1; k < _threads; ++k) {
+		worker& victim = *_workers[(id + k) % _threads];
+		int begin, end;
+		{
+			std::lock_guard<std::mutex> guard(victim.lock);
+			if (victim.begin >= victim.end) continue;
+			// take the back half, or the last job
+			begin = victim.begin + (victim.end - victim.begin) / 2;
+			end = victim.end;
+			victim.end = begin;
+		}
+		std::lock_guard<std::mutex> guard(self.lock);
+		self.begin = begin + 1;
+		self.end = end;
+		return begin;
+	}
+	return -1;
+}
+
+template <typename _Heap>
+void query_server<_Heap>::_work(int id) {
+	int seen = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> guard(_lock);
+			_wake.wait(guard, [&] { return _stop || _generation != seen; });
+			if (_stop) return;
+			seen = _generation;
+		}
+		for (int j = _next_job(id); j != -1; j = _next_job(id)) {
+			pair<int, int> q = (*_queries)[j];
+			(*_results)[j] = _g.widest(q.first, q.second, _workers[id]->ws);
+		}
+		std::lock_guard<std::mutex> guard(_lock);
+		if (--_running == 0) _done.notify_all();
+	}
+}
+
+template <typename _Heap>
+vector<pair<vector<int>, typename query_server<_Heap>::weight_type>> query_server<_Heap>::run(
+	vector<pair<int, int>> const& queries) {
+	int q = queries.size();
+	vector<pair<vector<int>, weight_type>> results(q);
+	for (int i = 0; i < _threads; ++i) {
+		std::lock_guard<std::mutex> guard(_workers[i]->lock);
+		_workers[i]->begin = (int64_t)q * i / _threads;
+		_workers[i]->end = (int64_t)q * (i + 1) / _threads;
+	}
+	std::unique_lock<std::mutex> guard(_lock);
+	_queries = &queries;
+	_results = &results;
+	_running = _threads;
+	++_generation;
+	_wake.notify_all();
+	_done.wait(guard, [&] { return _running == 0; });
+	return results;
+}
+
+template <typename _Heap>
+query_server<_Heap>::~query_server() {
+	{
+		std::lock_guard<std::mutex> guard(_lock);
+		_stop = true;
+	}
+	_wake.notify_all();
+	for (auto& th : _pool) th.join();
+	for (int i = 0; i < _threads; ++i) delete _workers[i];
+}
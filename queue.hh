@@ -1,50 +1,48 @@
 #pragma once
-// queue using linked lists
-// no headers needed
+#include "util.hh"
+#include "vector.hh"
+
+// queue in a circular buffer
+// Elements are stored in place, so pushing allocates nothing until the buffer is full,
+// and then doubles it. Sized up front (e.g. to n for a BFS) it allocates exactly once.
 template <typename T>
-class queue {
+class ring_queue {
    private:
-	class node;
-	using pointer = node*;
-	pointer _head = nullptr, _tail = nullptr;
+	vector<T> _buffer;
+	// capacity - 1, the capacity is a power of two
+	size_t _mask;
+	size_t _head = 0;
 	size_t _size = 0;
+	void _grow() {
+		vector<T> larger(2 * (_mask + 1));
+		for (size_t i = 0; i < _size; ++i) larger[i] = _buffer[(_head + i) & _mask];
+		_buffer = std::move(larger);
+		_mask = 2 * (_mask + 1) - 1;
+		_head = 0;
+	}
 
    public:
+	ring_queue(size_t capacity = 16) {
+		size_t c = 16;
+		while (c < capacity) c <<= 1;
+		_buffer = vector<T>(c);
+		_mask = c - 1;
+	}
 	inline size_t size() const { return _size; }
 	void push(T const& a) {
-        ++_size;
-		if (_tail == nullptr) {
-			_head = new node(a);
-            _tail = _head;
-			return;
-		}
-		_tail->next = new node(a);
-		_tail = _tail->next;
+		if (_size == _mask + 1) _grow();
+		_buffer[(_head + _size++) & _mask] = a;
 	}
 	T pop() {
-        --_size;
-		assert(_head != nullptr);
-		T res = _head->data;
-		pointer tmp = _head->next;
-		delete _head;
-		_head = tmp;
-        if (tmp == nullptr) _tail = nullptr;
+		assert(_size > 0);
+		T res = _buffer[_head];
+		_head = (_head + 1) & _mask;
+		--_size;
 		return res;
 	}
-	~queue() {
-		for (pointer tmp1 = _head; tmp1 != nullptr;) {
-			pointer tmp2 = tmp1->next;
-			delete tmp1;
-			tmp1 = tmp2;
-		}
+	// empty the queue, keeping its buffer
+	void clear() {
+		_head = 0;
+		_size = 0;
 	}
 };
-
-template <typename T>
-class queue<T>::node {
-   public:
-	T data;
-	node* next;
-	node(T const& _data) : data(_data), next(nullptr) {}
-	node(T const& _data, node* _next) : data(_data), next(_next) {}
-};
\ No newline at end of file
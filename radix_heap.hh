@@ -0,0 +1,106 @@
+#pragma once
+// for uint64_t
+#include <cstdint>
+// for std::numeric_limits
+#include <limits>
+// for std::is_integral
+#include <type_traits>
+
+#include "util.hh"
+#include "vector.hh"
+// Indexed monotone radix max heap for integer keys
+// Only valid when no key is ever inserted or increased above the last extracted maximum,
+// which holds for widest path searches (a key is never wider than the vertex it came from)
+// and for Kruskal (keys are only extracted). Keys are bucketed by the highest bit in which
+// they differ from the last extracted maximum, so every operation is O(1) amortized except
+// extract_max, which is O(log C) amortized for keys below C.
+template <typename _Value>
+class radix_heap {
+	static_assert(std::is_integral<_Value>::value, "radix_heap needs integer keys");
+
+   public:
+	using value_type = _Value;
+
+   private:
+	static const int _buckets = 65;
+	vector<_Value> D;
+	// distance of every key below the top of the key range, so the maximum is the minimum
+	vector<uint64_t> K;
+	// bucket lists linked through next / prev
+	vector<int> next, prev, bucket;
+	int head[_buckets];
+	uint64_t last = 0;
+	int _size = 0;
+	static uint64_t _key(_Value value) {
+		return (uint64_t)std::numeric_limits<_Value>::max() - (uint64_t)value;
+	}
+	int _bucket_of(uint64_t key) { return key == last ? 0 : 64 - __builtin_clzll(key ^ last); }
+	void _push(int x) {
+		int b = _bucket_of(K[x]);
+		bucket[x] = b;
+		prev[x] = -1;
+		next[x] = head[b];
+		if (head[b] != -1) prev[head[b]] = x;
+		head[b] = x;
+	}
+	void _remove(int x) {
+		if (prev[x] != -1) next[prev[x]] = next[x];
+		else
+			head[bucket[x]] = next[x];
+		if (next[x] != -1) prev[next[x]] = prev[x];
+	}
+	// make sure bucket 0 holds the maximum by splitting the first non empty bucket
+	void _pull() {
+		if (head[0] != -1) return;
+		int b = 1;
+		while (head[b] == -1) ++b;
+		last = K[head[b]];
+		for (int x = next[head[b]]; x != -1; x = next[x]) last = min(last, K[x]);
+		int x = head[b];
+		head[b] = -1;
+		while (x != -1) {
+			int tmp = next[x];
+			_push(x);
+			x = tmp;
+		}
+	}
+
+   public:
+	radix_heap(int n) : D(n), K(n), next(n, -1), prev(n, -1), bucket(n, -1) {
+		for (int b = 0; b < _buckets; ++b) head[b] = -1;
+	}
+	template <typename _Data>
+	radix_heap(_Data const& data) : radix_heap((int)data.size()) {
+		for (int i = 0; i < (int)data.size(); ++i) insert(i, data[i]);
+	}
+	pair<int, _Value> peek() {
+		_pull();
+		return {head[0], D[head[0]]};
+	}
+	pair<int, _Value> extract_max() {
+		pair<int, _Value> res = peek();
+		_remove(res.first);
+		--_size;
+		return res;
+	}
+	int size() { return this->_size; }
+	// empty the heap, keeping its storage (insert relinks every node it is given)
+	void reset() {
+		for (int b = 0; b < _buckets; ++b) head[b] = -1;
+		last = 0;
+		_size = 0;
+	}
+	void increase_key(int x, _Value value) {
+		_remove(x);
+		D[x] = value;
+		K[x] = _key(value);
+		_push(x);
+	}
+	void insert(int x, _Value value) {
+		++_size;
+		D[x] = value;
+		K[x] = _key(value);
+		assert(K[x] >= last);
+		_push(x);
+	}
+};
@@ -0,0 +1,95 @@
+#pragma once
+// for uint64_t
+#include <cstdint>
+// for memcpy
+#include <cstring>
+// for the parallel passes
+#include <thread>
+#include <type_traits>
+
+#include "util.hh"
+#include "vector.hh"
+
+// run fn(chunk, lo, hi) over [0, count) split into chunks, one thread per chunk
+// returns the number of chunks, small inputs are handled by the calling thread
+template <typename _Fn>
+static int _parallel_chunks(int threads, int count, _Fn fn) {
+	int chunks = count < (1 << 16) ? 1 : threads;
+	if (chunks == 1) {
+		fn(0, 0, count);
+		return 1;
+	}
+	vector<std::thread> pool;
+	pool.reserve(chunks);
+	for (int c = 0; c < chunks; ++c)
+		pool.push_back(std::thread(fn, c, (int64_t)count * c / chunks,
+								   (int64_t)count * (c + 1) / chunks));
+	for (auto& th : pool) th.join();
+	return chunks;
+}
+
+// key of x as an unsigned integer in the same order as x, for radix_order
+// Signed values get their sign bit flipped; for doubles that also works on positive
+// values, negative ones have every bit flipped since their magnitude grows downwards.
+template <typename T>
+inline uint64_t radix_key(T x) {
+	if constexpr (std::is_floating_point<T>::value) {
+		double d = x;
+		uint64_t bits;
+		memcpy(&bits, &d, sizeof bits);
+		return bits >> 63 ? ~bits : bits | (uint64_t)1 << 63;
+	} else if constexpr (std::is_signed<T>::value) {
+		return (uint64_t)(int64_t)x ^ (uint64_t)1 << 63;
+	} else {
+		return (uint64_t)x;
+	}
+}
+
+// Stable LSD radix sort
+// Returns the permutation of [0, keys.size()) that sorts the keys ascending, equal keys in
+// index order. Every pass moves the ids with their keys by 11 bits of the key in two
+// sequential sweeps, a count and a scatter. Digits on which every key agrees are skipped,
+// so keys that span 31 bits take 3 passes whatever their width. With threads > 1 both
+// sweeps are split into contiguous chunks; every chunk scatters behind the chunks before
+// it in each bucket, which keeps the sort stable and the result the same for any number
+// of threads.
+inline vector<int> radix_order(vector<uint64_t> keys, int threads = 1) {
+	const int bits = 11, radix = 1 << bits;
+	int m = keys.size();
+	vector<int> ids(m), next_ids(m);
+	vector<uint64_t> next_keys(m);
+	uint64_t varying = 0;
+	for (int i = 0; i < m; ++i) {
+		ids[i] = i;
+		varying |= keys[i] ^ keys[0];
+	}
+	// count[c * radix + d] is the number of keys of chunk c with digit d, then where the
+	// next of them goes
+	vector<int> count(max(threads, 1) * radix);
+	for (int shift = 0; shift < 64; shift += bits) {
+		if ((varying >> shift & (radix - 1)) == 0) continue;
+		for (int i = 0; i < (int)count.size(); ++i) count[i] = 0;
+		int chunks = _parallel_chunks(max(threads, 1), m, [&](int c, int lo, int hi) {
+			int* at = &count[c * radix];
+			for (int i = lo; i < hi; ++i) ++at[keys[i] >> shift & (radix - 1)];
+		});
+		int sum = 0;
+		for (int d = 0; d < radix; ++d)
+			for (int c = 0; c < chunks; ++c) {
+				int k = count[c * radix + d];
+				count[c * radix + d] = sum;
+				sum += k;
+			}
+		_parallel_chunks(max(threads, 1), m, [&](int c, int lo, int hi) {
+			int* at = &count[c * radix];
+			for (int i = lo; i < hi; ++i) {
+				int p = at[keys[i] >> shift & (radix - 1)]++;
+				next_keys[p] = keys[i];
+				next_ids[p] = ids[i];
+			}
+		});
+		std::swap(keys, next_keys);
+		std::swap(ids, next_ids);
+	}
+	return ids;
+}
@@ -0,0 +1,97 @@
+#pragma once
+// for std::sort
+#include <algorithm>
+
+#include "csr.hh"
+#include "util.hh"
+#include "vector.hh"
+
+// Vertex orders for locality
+// Each order is a permutation of the vertices, order[i] being the vertex to put at id i.
+// Generated and imported graphs number their vertices at random, so the neighbours of a
+// vertex are scattered over every per-vertex array a search touches. Renumbering in one of
+// these orders puts neighbours at nearby ids, and their entries in the same cache lines.
+//   bfs     breadth first, component by component: neighbours end up in nearby levels
+//   rcm     reverse Cuthill-McKee, breadth first from a vertex of least degree with the
+//           neighbours of every vertex taken by increasing degree, then reversed; keeps
+//           the ids of neighbours closest together
+//   degree  by decreasing degree: the vertices most searches pass through share a few
+//           cache lines, regardless of structure
+enum class vertex_order { none, bfs, rcm, degree };
+
+inline const char* vertex_order_name(vertex_order order) {
+	static const char* names[] = {"none", "bfs", "rcm", "degree"};
+	return names[(int)order];
+}
+
+// vertices by decreasing degree, ties by id (counting sort)
+template <typename _Weight>
+vector<int> degree_order(csr<_Weight> const& adj) {
+	int n = adj.size(), max_degree = 0;
+	for (int v = 0; v < n; ++v) max_degree = max(max_degree, adj.degree(v));
+	vector<int> start(max_degree + 2, 0), order(n);
+	for (int v = 0; v < n; ++v) ++start[max_degree - adj.degree(v) + 1];
+	for (int d = 0; d <= max_degree; ++d) start[d + 1] += start[d];
+	for (int v = 0; v < n; ++v) order[start[max_degree - adj.degree(v)]++] = v;
+	return order;
+}
+
+// breadth first from every vertex not reached yet, in the order of roots; with
+// by_degree the new neighbours of every vertex are queued by increasing degree
+template <typename _Weight>
+vector<int> _bfs_order(csr<_Weight> const& adj, vector<int> const& roots, bool by_degree) {
+	int n = adj.size();
+	// the order itself is the queue, vertices from head on are still to expand
+	vector<int> order;
+	order.reserve(n);
+	vector<char> seen(n, 0);
+	for (int r : roots) {
+		if (seen[r]) continue;
+		seen[r] = 1;
+		order.push_back(r);
+		for (int head = order.size() - 1; head < (int)order.size(); ++head) {
+			int first = order.size();
+			for (auto edge : adj[order[head]])
+				if (!seen[edge.first]) {
+					seen[edge.first] = 1;
+					order.push_back(edge.first);
+				}
+			if (by_degree)
+				std::sort(&order[0] + first, &order[0] + order.size(), [&](int a, int b) {
+					return adj.degree(a) != adj.degree(b) ? adj.degree(a) < adj.degree(b) : a < b;
+				});
+		}
+	}
+	return order;
+}
+
+template <typename _Weight>
+vector<int> bfs_order(csr<_Weight> const& adj) {
+	vector<int> roots(adj.size());
+	for (int v = 0; v < adj.size(); ++v) roots[v] = v;
+	return _bfs_order(adj, roots, false);
+}
+
+template <typename _Weight>
+vector<int> rcm_order(csr<_Weight> const& adj) {
+	// every component starts at its vertex of least degree
+	vector<int> roots = degree_order(adj);
+	reverse(roots.begin(), roots.end());
+	vector<int> order = _bfs_order(adj, roots, true);
+	reverse(order.begin(), order.end());
+	return order;
+}
+
+// the order named by how, the identity for vertex_order::none
+template <typename _Weight>
+vector<int> make_vertex_order(csr<_Weight> const& adj, vertex_order how) {
+	switch (how) {
+		case vertex_order::bfs: return bfs_order(adj);
+		case vertex_order::rcm: return rcm_order(adj);
+		case vertex_order::degree: return degree_order(adj);
+		default: break;
+	}
+	vector<int> order(adj.size());
+	for (int v = 0; v < adj.size(); ++v) order[v] = v;
+	return order;
+}
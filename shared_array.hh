@@ -0,0 +1,35 @@
+#pragma once
+// for std::shared_ptr
+#include <memory>
+
+#include "util.hh"
+#include "vector.hh"
+
+// Read only array whose copies share the same elements
+// The elements either live in a vector handed over to the array, or in memory owned by
+// someone else, e.g. a mapped graph file. The owner is kept alive as long as any copy
+// of the array exists, so frozen data can be passed around without copying it.
+template <typename T>
+class shared_array {
+   private:
+	T const* _data = nullptr;
+	size_t _size = 0;
+	std::shared_ptr<void const> _owner;
+
+   public:
+	shared_array() {}
+	// take over the elements of a vector
+	shared_array(vector<T>&& elems) : _size(elems.size()) {
+		auto store = std::make_shared<vector<T>>(std::move(elems));
+		if (_size > 0) _data = &(*store)[0];
+		_owner = std::move(store);
+	}
+	// size elements at data, kept alive by owner
+	shared_array(T const* data, size_t size, std::shared_ptr<void const> owner)
+		: _data(data), _size(size), _owner(std::move(owner)) {}
+	size_t size() const { return _size; }
+	T const& operator[](size_t i) const { return _data[i]; }
+	T const* data() const { return _data; }
+	T const* begin() const { return _data; }
+	T const* end() const { return _data + _size; }
+};
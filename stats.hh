@@ -0,0 +1,127 @@
+#pragma once
+// for steady_clock where there is no cycle counter
+#include <chrono>
+// for int64_t
+#include <cstdint>
+// for the JSON export
+#include <string>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define STATS_RDTSC 1
+// for __rdtsc
+#include <x86intrin.h>
+#endif
+
+// Counters and phase timers of the searches, compiled in with -DGRAPH_STATS
+// Without GRAPH_STATS every STAT_ macro expands to nothing, so the searches are exactly
+// as fast as before. With it each thread records into its own query_stats::current():
+// reset it before a query, read it or its json() after.
+//
+//   STAT_ADD(counter, amount) / STAT_INC(counter)  add to a counter of query_stats
+//   STAT_TIMER(timer)                            start a local timer
+//   STAT_LAP(timer, phase)                       charge the cycles since the last lap to phase
+
+// phases a query goes through, each algorithm uses those it has
+enum class stat_phase { setup, sort, search, forest, bfs, output, count };
+
+inline const char* stat_phase_name(stat_phase phase) {
+	static const char* names[] = {"setup", "sort", "search", "forest", "bfs", "output"};
+	return names[(int)phase];
+}
+
+// cycles on x86 (the time stamp counter), nanoseconds elsewhere
+inline int64_t stat_cycles() {
+#ifdef STATS_RDTSC
+	return (int64_t)__rdtsc();
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			   std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+#endif
+}
+
+struct query_stats {
+	// heap operations of the Dijkstra searches and kruskal, whatever the heap
+	int64_t heap_inserts = 0;
+	int64_t heap_increase_keys = 0;
+	int64_t heap_extractions = 0;
+	// levels moved by sifting up or down, counted by heap (binary) only
+	int64_t heap_sift_steps = 0;
+	// edges looked at and vertices finalized by the Dijkstra searches
+	int64_t relaxations = 0;
+	int64_t settled = 0;
+	// union_find::find calls of kruskal and the parents they skipped by path halving
+	int64_t dsu_finds = 0;
+	int64_t dsu_compressions = 0;
+	// vertices pushed by the BFS over the spanning tree
+	int64_t queue_pushes = 0;
+	int64_t cycles[(int)stat_phase::count] = {};
+
+	// stats of the calling thread
+	static query_stats& current() {
+		static thread_local query_stats stats;
+		return stats;
+	}
+	void reset() { *this = query_stats(); }
+	query_stats& operator+=(query_stats const& other) {
+		heap_inserts += other.heap_inserts;
+		heap_increase_keys += other.heap_increase_keys;
+		heap_extractions += other.heap_extractions;
+		heap_sift_steps += other.heap_sift_steps;
+		relaxations += other.relaxations;
+		settled += other.settled;
+		dsu_finds += other.dsu_finds;
+		dsu_compressions += other.dsu_compressions;
+		queue_pushes += other.queue_pushes;
+		for (int p = 0; p < (int)stat_phase::count; ++p) cycles[p] += other.cycles[p];
+		return *this;
+	}
+	// one JSON object, the cycles of every phase in a nested "cycles" object
+	std::string json() const {
+		std::string out = "{";
+		auto field = [&](const char* name, int64_t value) {
+			if (out.size() > 1 && out.back() != '{') out += ", ";
+			out += "\"";
+			out += name;
+			out += "\": " + std::to_string(value);
+		};
+		field("heap_inserts", heap_inserts);
+		field("heap_increase_keys", heap_increase_keys);
+		field("heap_extractions", heap_extractions);
+		field("heap_sift_steps", heap_sift_steps);
+		field("relaxations", relaxations);
+		field("settled", settled);
+		field("dsu_finds", dsu_finds);
+		field("dsu_compressions", dsu_compressions);
+		field("queue_pushes", queue_pushes);
+		out += ", \"cycles\": {";
+		for (int p = 0; p < (int)stat_phase::count; ++p)
+			field(stat_phase_name((stat_phase)p), cycles[p]);
+		out += "}}";
+		return out;
+	}
+};
+
+// cycles between laps go to the phase named by each lap
+class stat_timer {
+   private:
+	int64_t _last = stat_cycles();
+
+   public:
+	void lap(stat_phase phase) {
+		int64_t now = stat_cycles();
+		query_stats::current().cycles[(int)phase] += now - _last;
+		_last = now;
+	}
+};
+
+#ifdef GRAPH_STATS
+#define STAT_ADD(counter, amount) (query_stats::current().counter += (amount))
+#define STAT_TIMER(timer) stat_timer timer
+#define STAT_LAP(timer, phase) timer.lap(stat_phase::phase)
+#else
+#define STAT_ADD(counter, amount) ((void)0)
+#define STAT_TIMER(timer)
+#define STAT_LAP(timer, phase) ((void)0)
+#endif
+#define STAT_INC(counter) STAT_ADD(counter, 1)
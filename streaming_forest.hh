@@ -0,0 +1,141 @@
+#pragma once
+// for std::inplace_merge and std::stable_sort
+#include <algorithm>
+// for fopen, fread and fseeko
+#include <cstdio>
+
+#include "csr.hh"
+#include "graph_file.hh"
+#include "union_find.hh"
+#include "util.hh"
+#include "vector.hh"
+
+// Maximum spanning forest of a stream of edges, in O(n + chunk) memory
+// Edges are buffered until a chunk is full, then the chunk is sorted heaviest first,
+// merged with the forest found so far (kept in the same order) and reduced by Kruskal's
+// algorithm over a fresh union_find. An edge dropped by a reduction closes a cycle of
+// heavier edges, so it is in no maximum spanning forest of the whole stream either. Once
+// the forest spans every vertex, an edge no heavier than its narrowest edge is dropped on
+// arrival without being buffered. Ties go to the edge that came first, so the forest is
+// the one Kruskal's algorithm finds over the whole edge list (graph::kruskal).
+// The result is a CSR tree, which basic_bottleneck_oracle indexes for path queries.
+template <typename _Weight = graph::weight_type>
+class streaming_forest {
+   private:
+	struct _edge {
+		int u, v;
+		_Weight w;
+	};
+	int _n;
+	size_t _chunk;
+	// the forest, heaviest first, followed by the edges of the current chunk
+	vector<_edge> _buf;
+	int _forest = 0;
+	static bool _heavier(_edge const& a, _edge const& b) { return a.w > b.w; }
+	size_t _limit() const { return _chunk > 0 ? _chunk : max((size_t)_n, (size_t)1 << 20); }
+	void _reduce() {
+		std::stable_sort(&_buf[0] + _forest, &_buf[0] + _buf.size(), _heavier);
+		std::inplace_merge(&_buf[0], &_buf[0] + _forest, &_buf[0] + _buf.size(), _heavier);
+		union_find forest(_n);
+		int kept = 0;
+		for (size_t i = 0; i < _buf.size() && kept < _n - 1; ++i)
+			if (forest.unify(_buf[i].u, _buf[i].v)) _buf[kept++] = _buf[i];
+		// the capacity is kept for the next chunk
+		while ((int)_buf.size() > kept) _buf.pop_back();
+		_forest = kept;
+	}
+
+   public:
+	// n vertices, more are added as edges name them; chunk edges are buffered between
+	// reductions, 0 picks max(n, 2^20)
+	streaming_forest(int n = 0, size_t chunk = 0) : _n(n), _chunk(chunk) {}
+	int size() const { return _n; }
+	// make room for vertices up to n - 1 that may have no edge
+	void grow(int n) { _n = max(_n, n); }
+	void add(int u, int v, _Weight w) {
+		assert(u >= 0 && v >= 0 && u != v);
+		if (max(u, v) >= _n) _n = max(u, v) + 1;
+		// a spanning forest only takes heavier edges, and buffering is the costly part
+		else if (_forest == _n - 1 && _forest > 0 && !(w > _buf[_forest - 1].w))
+			return;
+		// room for a spanning forest and a whole chunk, so the buffer never doubles past them
+		if (_buf.size() == _buf.capacity()) _buf.reserve(max((size_t)_n, (size_t)_forest + 1) + _limit());
+		_buf.push_back({u, v, w});
+		if (_buf.size() - _forest >= _limit()) _reduce();
+	}
+	// the forest of every edge added so far
+	csr<_Weight> forest() {
+		if (_buf.size() > (size_t)_forest) _reduce();
+		vector<pair<int, int>> edges(_forest);
+		vector<_Weight> weights(_forest);
+		for (int i = 0; i < _forest; ++i) {
+			edges[i] = pair<int, int>(_buf[i].u, _buf[i].v);
+			weights[i] = _buf[i].w;
+		}
+		return csr<_Weight>(_n, edges, weights);
+	}
+};
+
+// maximum spanning forest of a text graph (see import_graph), read in one pass
+template <typename _Weight = graph::weight_type>
+csr<_Weight> stream_spanning_forest(const char* path, text_format format,
+									bool symmetric_arcs = true, size_t chunk = 0) {
+	streaming_forest<_Weight> forest(0, chunk);
+	int64_t max_weight = std::is_integral<_Weight>::value
+							 ? (int64_t)std::numeric_limits<_Weight>::max()
+							 : std::numeric_limits<int64_t>::max();
+	int64_t declared = _read_text_edges(path, format, symmetric_arcs, max_weight,
+										[&](int u, int v, int64_t w) { forest.add(u, v, w); });
+	// isolated vertices declared by a DIMACS file
+	if (declared > 0) forest.grow(declared);
+	return forest.forest();
+}
+
+// maximum spanning forest of a graph file, reading its edge list in chunks instead of
+// mapping it, in the caller's ids of a reordered graph
+template <typename _Weight = graph::weight_type>
+csr<_Weight> stream_spanning_forest(const char* path, size_t chunk = 0) {
+	graph_file_header h;
+	vector<int> labels;
+	{
+		mapped_file file(path);
+		h = _graph_file_header(file);
+		if (h.labels != 0) {
+			labels = vector<int>(h.n);
+			for (uint64_t v = 0; v < h.n; ++v) labels[v] = ((int const*)(file.data() + h.labels))[v];
+		}
+	}
+	streaming_forest<_Weight> forest(h.n, chunk);
+	FILE* in = std::fopen(path, "rb");
+	if (in == nullptr) throw generic_exception("cannot open graph file");
+	const size_t block = 1 << 16;
+	vector<pair<int, int>> edges(block);
+	vector<int64_t> weights(block);
+	for (uint64_t done = 0; done < h.m;) {
+		size_t count = min((uint64_t)block, h.m - done);
+		bool ok = fseeko(in, h.edges + done * sizeof(pair<int, int>), SEEK_SET) == 0 &&
+				  std::fread(&edges[0], sizeof(pair<int, int>), count, in) == count &&
+				  fseeko(in, h.edge_weights + done * sizeof(int64_t), SEEK_SET) == 0 &&
+				  std::fread(&weights[0], sizeof(int64_t), count, in) == count;
+		if (!ok) {
+			std::fclose(in);
+			throw generic_exception("cannot read graph file");
+		}
+		for (size_t i = 0; i < count; ++i) {
+			int u = edges[i].first, v = edges[i].second;
+			if (labels.size() > 0) {
+				u = labels[u];
+				v = labels[v];
+			}
+			if (weights[i] < 1 ||
+				(long double)weights[i] > (long double)std::numeric_limits<_Weight>::max()) {
+				std::fclose(in);
+				throw generic_exception("graph file weight out of range");
+			}
+			forest.add(u, v, weights[i]);
+		}
+		done += count;
+	}
+	std::fclose(in);
+	return forest.forest();
+}
@@ -0,0 +1,108 @@
+#pragma once
+// for the concurrent variant
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "stats.hh"
+#include "util.hh"
+#include "vector.hh"
+
+// Disjoint set union with union by size and iterative path halving
+// unify accepts any two elements, not only roots, and reports whether they were merged.
+class union_find {
+   private:
+	int _n;
+	int _components;
+	vector<int> parent, _size;
+
+   public:
+	union_find(int n) : _n(n), _components(n), parent(n), _size(n, 1) {
+		for (int i = 0; i < _n; ++i) parent[i] = i;
+	}
+	// every other node on the way to the root is pointed at its grandparent
+	int find(int x) {
+		STAT_INC(dsu_finds);
+		while (parent[x] != x) {
+			STAT_INC(dsu_compressions);
+			parent[x] = parent[parent[x]];
+			x = parent[x];
+		}
+		return x;
+	}
+	bool unify(int a, int b) {
+		a = find(a);
+		b = find(b);
+		if (a == b) return false;
+		if (_size[a] < _size[b]) std::swap(a, b);
+		parent[b] = a;
+		_size[a] += _size[b];
+		--_components;
+		return true;
+	}
+	bool connected(int a, int b) { return find(a) == find(b); }
+	// number of elements in the set of x
+	int size(int x) { return _size[find(x)]; }
+	int components() const { return _components; }
+};
+
+// Lock-free disjoint set union, find / unify / connected may be called from many threads
+// Roots are linked with a compare-and-swap, always below the root with the higher random
+// priority, which keeps trees shallow in expectation without a separate rank array.
+// find halves paths with compare-and-swaps, a failed one only means another thread
+// already shortened the path.
+class concurrent_union_find {
+   private:
+	int _n;
+	std::unique_ptr<std::atomic<int>[]> parent;
+	// fixed pseudo random priority of every element
+	static uint32_t _priority(uint32_t x) {
+		x ^= x >> 16;
+		x *= 0x7feb352d;
+		x ^= x >> 15;
+		x *= 0x846ca68b;
+		x ^= x >> 16;
+		return x;
+	}
+	// a is linked below b
+	static bool _below(int a, int b) {
+		uint32_t pa = _priority(a), pb = _priority(b);
+		return pa < pb || (pa == pb && a < b);
+	}
+
+   public:
+	concurrent_union_find(int n) : _n(n), parent(new std::atomic<int>[n]) {
+		for (int i = 0; i < _n; ++i) parent[i].store(i, std::memory_order_relaxed);
+	}
+	int size() const { return _n; }
+	int find(int x) {
+		while (true) {
+			int p = parent[x].load(std::memory_order_acquire);
+			if (p == x) return x;
+			int gp = parent[p].load(std::memory_order_acquire);
+			if (p != gp) parent[x].compare_exchange_weak(p, gp, std::memory_order_acq_rel);
+			x = gp;
+		}
+	}
+	bool unify(int a, int b) {
+		while (true) {
+			a = find(a);
+			b = find(b);
+			if (a == b) return false;
+			if (!_below(a, b)) std::swap(a, b);
+			int expected = a;
+			// fails if a stopped being a root meanwhile, then retry from the new roots
+			if (parent[a].compare_exchange_strong(expected, b, std::memory_order_acq_rel))
+				return true;
+		}
+	}
+	bool connected(int a, int b) {
+		while (true) {
+			a = find(a);
+			b = find(b);
+			if (a == b) return true;
+			// a was still a root after b was found, so they really are apart
+			if (parent[a].load(std::memory_order_acquire) == a) return false;
+		}
+	}
+};
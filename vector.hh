@@ -1,53 +1,83 @@
 #pragma once
-// for memcpy and memmove
+// for memcpy
 #include <cstring>
 // for dynamic memory
 #include <memory>
 // for template checks
 #include <type_traits>
+// for std::move_if_noexcept
+#include <utility>
 
-template <typename T>
+// Growable array
+// Capacity doubles when full, so push_back and emplace_back are amortized O(1). Elements
+// are relocated with memcpy when T is trivially movable and destructible, and with its
+// move constructor (or copy constructor if moving may throw) otherwise. Memory comes
+// from _Alloc.
+template <typename T, typename _Alloc = std::allocator<T>>
 class vector {
    private:
 	using pointer = T *;
+	using traits = std::allocator_traits<_Alloc>;
 	pointer _start = nullptr;
 	pointer _finish = nullptr;
 	pointer _end_of_storage = nullptr;
-	std::allocator<T> _alloc;
-	// Destroy allocated memory
-	void _Destroy(pointer begin, pointer end) {
-		if (!std::is_trivially_destructible<T>::value) std::destroy_n(begin, end - begin);
-		_alloc.deallocate(begin, end - begin);
-	}
-	// reallocate an uninitialized chunk of extra memory
-	void _realloc() {
+	_Alloc _alloc;
+	// destroy the elements in [begin, end)
+	void _destroy(pointer begin, pointer end) {
+		if (!std::is_trivially_destructible<T>::value)
+			for (; begin != end; ++begin) traits::destroy(_alloc, begin);
+	}
+	// destroy every element and free the whole capacity
+	void _free() {
+		if (_start == nullptr) return;
+		_destroy(_start, _finish);
+		traits::deallocate(_alloc, _start, _end_of_storage - _start);
+		_start = _finish = _end_of_storage = nullptr;
+	}
+	// move the elements to a new chunk of exactly capacity elements
+	void _relocate(size_t capacity) {
+		size_t n_elems = _finish - _start;
+		pointer start = capacity > 0 ? traits::allocate(_alloc, capacity) : nullptr;
+		if (std::is_trivially_move_constructible<T>::value &&
+			std::is_trivially_destructible<T>::value) {
+			if (n_elems > 0) std::memcpy((void *)start, (void const *)_start, n_elems * sizeof(T));
+		} else {
+			for (size_t i = 0; i < n_elems; ++i)
+				traits::construct(_alloc, start + i, std::move_if_noexcept(_start[i]));
+		}
+		_free();
+		_start = start;
+		_finish = start + n_elems;
+		_end_of_storage = start + capacity;
+	}
+	// make room for one more element
+	void _grow() {
 		if (_finish == _end_of_storage) {
-			pointer _old_start = _start;
-			pointer _old_finish = _finish;
-			pointer _old_end_of_storage = _end_of_storage;
-			size_t _n_elems = _old_finish - _old_start;
-			_start = _alloc.allocate(_n_elems + 1, _start);
-			_end_of_storage = _start + _n_elems + 1;
-			_finish = _start + _n_elems;
-			if (_old_start != _start) {
-				std::memmove(_start, _old_start, _n_elems * sizeof(T));
-				_Destroy(_old_start, _old_end_of_storage);
-			}
+			size_t capacity = _end_of_storage - _start;
+			_relocate(capacity < 4 ? 4 : 2 * capacity);
 		}
 	}
 	// copy from other vector
-	void _copy(vector<T> const &other) {
-		if (_start != nullptr) _Destroy(_start, _end_of_storage);
-		size_t capacity = other._end_of_storage - other._start;
-		size_t n_elems = other._finish - other._start;
-		_start = _alloc.allocate(capacity);
-		_finish = _start + n_elems;
-		_end_of_storage = _start + capacity;
-		for (pointer tmp1 = _start, tmp2 = other._start; tmp2 != other._finish;) *tmp1++ = *tmp2++;
+	void _copy(vector const &other) {
+		if (this == &other) return;
+		_free();
+		size_t n_elems = other.size();
+		if (n_elems == 0) return;
+		_start = traits::allocate(_alloc, n_elems);
+		_end_of_storage = _start + n_elems;
+		if (std::is_trivially_copy_constructible<T>::value) {
+			std::memcpy((void *)_start, (void const *)other._start, n_elems * sizeof(T));
+			_finish = _end_of_storage;
+		} else {
+			for (_finish = _start; _finish != _end_of_storage; ++_finish)
+				traits::construct(_alloc, _finish, other._start[_finish - _start]);
+		}
 	}
 	// move from another vector
-	void _move(vector<T> &&other) {
-		if (_start != nullptr) _Destroy(_start, _end_of_storage);
+	void _move(vector &&other) {
+		if (this == &other) return;
+		_free();
+		_alloc = std::move(other._alloc);
 		_start = other._start;
 		_finish = other._finish;
 		_end_of_storage = other._end_of_storage;
@@ -58,74 +88,123 @@ class vector {
 
    public:
 	class iterator;
-	vector() : _start(nullptr), _finish(nullptr), _end_of_storage(nullptr) {}
-	vector(size_t capacity) {
-		_start = _alloc.allocate(capacity);
-		_finish = _start + capacity;
+	vector() {}
+	explicit vector(_Alloc const &alloc) : _alloc(alloc) {}
+	// size default initialized elements (left uninitialized for trivial T)
+	vector(size_t size, _Alloc const &alloc = _Alloc()) : _alloc(alloc) {
+		if (size == 0) return;
+		_start = traits::allocate(_alloc, size);
+		_finish = _start + size;
 		_end_of_storage = _finish;
-		std::uninitialized_default_construct_n(_start, capacity);
+		std::uninitialized_default_construct_n(_start, size);
 	}
-	size_t size() const { return _finish - _start; }
-	vector(size_t capacity, T const &elem) : vector(capacity) {
-		for (pointer _tmp = _start; _tmp != _finish; _tmp++) { *_tmp = elem; }
+	vector(size_t size, T const &elem, _Alloc const &alloc = _Alloc()) : _alloc(alloc) {
+		if (size == 0) return;
+		_start = traits::allocate(_alloc, size);
+		_finish = _start + size;
+		_end_of_storage = _finish;
+		std::uninitialized_fill_n(_start, size, elem);
+	}
+	vector(vector const &other) : _alloc(traits::select_on_container_copy_construction(other._alloc)) {
+		_copy(other);
 	}
-	vector(vector<T> const &other) { _copy(other); }
-	vector(vector<T> &&other) { _move(std::forward<vector<T>>(other)); }
+	vector(vector &&other) : _alloc(std::move(other._alloc)) { _move(std::move(other)); }
 
 	// copy assignment
-	vector<T> &operator=(vector<T> const &other) {
+	vector &operator=(vector const &other) {
 		_copy(other);
 		return *this;
 	}
 
 	// move assignment
-	vector<T> &operator=(vector<T> &&other) {
-		_move(std::forward<vector<T>>(other));
+	vector &operator=(vector &&other) {
+		_move(std::move(other));
 		return *this;
 	}
 
-	bool operator==(vector<T> const &other) const {
+	bool operator==(vector const &other) const {
 		if (this->size() != other.size()) return false;
 		for (pointer t1 = _start, t2 = other._start; t1 != _finish;) {
 			if (*t1++ != *t2++) return false;
 		}
 		return true;
 	}
-	bool operator!=(vector<T> const &other) const { return !(*this == other); }
+	bool operator!=(vector const &other) const { return !(*this == other); }
+	size_t size() const { return _finish - _start; }
+	size_t capacity() const { return _end_of_storage - _start; }
+	bool empty() const { return _finish == _start; }
+	T *data() const { return _start; }
 	// index access
 	T &operator[](size_t const &_i) const { return *(_start + _i); }
+	T &back() const { return *(_finish - 1); }
 	void push_back(T const &elem) {
-		// realloc if out of space
-		_realloc();
-		// placement new
-		new (_finish++) T(elem);
+		// elem may live in this vector, so copy it before growing
+		if (_finish == _end_of_storage) {
+			T copy(elem);
+			_grow();
+			traits::construct(_alloc, _finish++, std::move(copy));
+			return;
+		}
+		traits::construct(_alloc, _finish++, elem);
 	}
+	void push_back(T &&elem) { emplace_back(std::move(elem)); }
+	// construct an element in place at the end
+	template <typename... _Args>
+	T &emplace_back(_Args &&...args) {
+		if (_finish == _end_of_storage) {
+			T elem(std::forward<_Args>(args)...);
+			_grow();
+			traits::construct(_alloc, _finish, std::move(elem));
+		} else
+			traits::construct(_alloc, _finish, std::forward<_Args>(args)...);
+		return *_finish++;
+	}
+	void pop_back() {
+		--_finish;
+		_destroy(_finish, _finish + 1);
+	}
+	// make room for capacity elements, never shrinks
 	void reserve(size_t capacity) {
-		pointer _old_start = _start;
-		pointer _old_finish = _finish;
-		pointer _old_end_of_storage = _end_of_storage;
-		size_t n_elems = _old_finish - _old_start;
-		_start = _alloc.allocate(capacity, _start);
-		_end_of_storage = _start + capacity;
-		_finish = _start + n_elems;
-		if (_old_start != _start) {
-			std::memmove(_start, _old_start, n_elems * sizeof(T));
-			_Destroy(_old_start, _old_end_of_storage);
+		if (capacity > this->capacity()) _relocate(capacity);
+	}
+	// grow with default initialized elements or drop the last ones
+	void resize(size_t size) {
+		if (size <= this->size()) {
+			_destroy(_start + size, _finish);
+			_finish = _start + size;
+			return;
+		}
+		if (size > capacity()) _relocate(size > 2 * capacity() ? size : 2 * capacity());
+		std::uninitialized_default_construct(_finish, _start + size);
+		_finish = _start + size;
+	}
+	void resize(size_t size, T const &elem) {
+		if (size <= this->size()) {
+			resize(size);
+			return;
 		}
+		// elem may live in this vector
+		T copy(elem);
+		if (size > capacity()) _relocate(size > 2 * capacity() ? size : 2 * capacity());
+		std::uninitialized_fill(_finish, _start + size, copy);
+		_finish = _start + size;
 	}
-	void push_back(T &&elem) {
-		// realloc if out of space
-		_realloc();
-		// placement new with move constructor
-		new (_finish++) T(std::forward<T>(elem));
+	// remove every element, keeping the capacity
+	void clear() {
+		_destroy(_start, _finish);
+		_finish = _start;
+	}
+	// free the capacity beyond size
+	void shrink_to_fit() {
+		if (_finish != _end_of_storage) _relocate(size());
 	}
 	iterator begin() const { return iterator(_start); }
 	iterator end() const { return iterator(_finish); }
-	~vector() { _Destroy(_start, _finish); }
+	~vector() { _free(); }
 };
 
-template <typename T>
-class vector<T>::iterator {
+template <typename T, typename _Alloc>
+class vector<T, _Alloc>::iterator {
    public:
 	using iterator_category = std::random_access_iterator_tag;
 	using difference_type = std::ptrdiff_t;
@@ -158,7 +237,7 @@ class vector<T>::iterator {
 	iterator operator--(int) {
 		iterator _res = *this;
 		--_t;
-		return *this;
+		return _res;
 	}
 
    private:
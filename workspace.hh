@@ -0,0 +1,72 @@
+#pragma once
+// for uint32_t and int64_t
+#include <cstdint>
+
+#include "heap.hh"
+#include "util.hh"
+#include "vector.hh"
+
+// Scratch state of one widest path search: status, dad, b_width and the fringe heap
+// A workspace is allocated once and reused by every query that is given it, so a
+// long running worker never allocates per query. It must not be shared between threads.
+// Every vertex carries the epoch of the query that last touched it. reset() only bumps
+// the epoch, and entries from older queries read as unseen, so a query costs only what
+// it touches instead of O(n) to clear the arrays. Bandwidths have the heap's value_type.
+template <typename _Heap = heap<int64_t>>
+class query_workspace {
+   public:
+	using weight_type = typename _Heap::value_type;
+
+   private:
+	// the state of a vertex is kept together, so a relaxation touches one cache line
+	struct slot {
+		uint32_t epoch;
+		// -1 unseen, 1 fringe, 0 finalized
+		int status;
+		int dad;
+		weight_type b_width;
+	};
+	int _n;
+	uint32_t _epoch = 1;
+	vector<slot> _slots;
+	slot& _touch(int v) {
+		slot& x = _slots[v];
+		if (x.epoch != _epoch) {
+			x.epoch = _epoch;
+			x.status = -1;
+			x.dad = -1;
+			x.b_width = 0;
+		}
+		return x;
+	}
+
+   public:
+	_Heap H;
+	query_workspace(int n) : _n(n), _slots(n), H(n) {
+		for (int i = 0; i < _n; ++i) _slots[i].epoch = 0;
+	}
+	int size() const { return _n; }
+	bool seen(int v) const { return _slots[v].epoch == _epoch; }
+	int& status(int v) { return _touch(v).status; }
+	int& dad(int v) { return _touch(v).dad; }
+	weight_type& b_width(int v) { return _touch(v).b_width; }
+	// vertices from s to t, following dad from t, empty if t was not reached
+	vector<int> path(const int t) {
+		vector<int> ans;
+		if (dad(t) == -1) return ans;
+		int c = t;
+		for (; dad(c) != c; c = dad(c)) ans.push_back(c);
+		ans.push_back(c);
+		reverse(ans.begin(), ans.end());
+		return ans;
+	}
+	// forget the previous query
+	void reset() {
+		if (++_epoch == 0) {
+			// the counter wrapped around, stale stamps could now look current
+			for (int i = 0; i < _n; ++i) _slots[i].epoch = 0;
+			_epoch = 1;
+		}
+		H.reset();
+	}
+};